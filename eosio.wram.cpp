@@ -2,40 +2,162 @@
 #include "src/token.cpp"
 #include "src/mirror.cpp"
 #include "src/egress.cpp"
+#include "src/query.cpp"
+#include "src/audit.cpp"
+#include "src/history.cpp"
+#include "src/market.cpp"
+#include "src/log.cpp"
+#include "src/metrics.cpp"
 
 namespace eosio {
 
 [[eosio::action]]
-void wram::unwrap( const name owner, const int64_t bytes )
+wram::transfer_result wram::unwrap( const name owner, const int64_t bytes )
 {
-   transfer(owner, get_self(), asset{bytes, RAM_SYMBOL}, "unwrap ram");
+   return transfer(owner, get_self(), asset{bytes, RAM_SYMBOL}, "unwrap ram");
 }
 
-void wram::unwrap_ram( const name to, const asset quantity )
+[[eosio::action]]
+void wram::unwrapto( const name owner, const vector<unwrap_params> recipients )
 {
+   require_auth(owner);
+   check(recipients.size() > 0, "recipients cannot be empty");
+
+   // validate recipients & total
+   asset quantity{0, RAM_SYMBOL};
+   for (const auto& recipient : recipients) {
+      check(is_account(recipient.to), "to account does not exist");
+      check(recipient.bytes > 0, "must unwrap positive quantity");
+      quantity += asset{recipient.bytes, RAM_SYMBOL};
+   }
+
+   // debit owner once with the total
+   require_recipient(owner);
+   const int64_t balance = sub_balance(owner, quantity, owner);
+   add_balance(get_self(), quantity, owner);
+
+   // update WRAM supply to reflect system RAM
+   const int64_t supply = mirror_system_ram(0, quantity.amount);
+
+   logunwrap_action logunwrap_act{get_self(), {get_self(), "active"_n}};
+   logunwrap_act.send(owner, -quantity.amount, balance, supply, supply);
+
+   // ramtransfer to each recipient
+   eosiosystem::system_contract::ramtransfer_action ramtransfer_act{"eosio"_n, {get_self(), "active"_n}};
+   for (const auto& recipient : recipients) {
+      ramtransfer_act.send(get_self(), recipient.to, recipient.bytes, "unwrap ram");
+   }
+}
+
+[[eosio::action]]
+void wram::unwrapsell( const name owner, const int64_t bytes, const asset min_out )
+{
+   require_auth(owner);
+
+   const asset quantity{bytes, RAM_SYMBOL};
+   check(quantity.is_valid(), "invalid quantity");
+   check(quantity.amount > 0, "must unwrap positive quantity");
+
+   // the quote only validates the sale, `sellram` may pay a different amount (see `settlesell`)
+   const asset quote = quote_sellram(bytes);
+   check(quote.symbol == min_out.symbol, "min_out symbol mismatch");
+
    // update WRAM supply to reflect system RAM
    mirror_system_ram();
 
+   // retire owner WRAM ahead of `sellram` releasing the bytes from system RAM
+   require_recipient(owner);
+   const int64_t balance = sub_balance(owner, quantity, owner);
+
+   stats statstable( get_self(), RAM_SYMBOL_CODE );
+   const auto& st = statstable.get( RAM_SYMBOL_CODE, "invalid supply symbol code" );
+   statstable.modify( st, same_payer, [&]( auto& s ) {
+      s.supply -= quantity;
+   });
+   const int64_t supply = st.supply.amount;
+   update_history(supply, supply, 0, bytes);
+
+   logunwrap_action logunwrap_act{get_self(), {get_self(), "active"_n}};
+   logunwrap_act.send(owner, -bytes, balance, supply, supply);
+
+   logmirror_action logmirror_act{get_self(), {get_self(), "active"_n}};
+   logmirror_act.send(get_self(), -bytes, get_balance(get_self(), get_self(), RAM_SYMBOL.code()).amount, supply, supply);
+
+   // sell RAM bytes, then send the proceeds actually received to owner
+   const asset before = get_core_balance(min_out.symbol);
+   eosiosystem::system_contract::sellram_action sellram_act{"eosio"_n, {get_self(), "active"_n}};
+   sellram_act.send(get_self(), bytes);
+
+   settlesell_action settlesell_act{get_self(), {get_self(), "active"_n}};
+   settlesell_act.send(owner, before, min_out);
+}
+
+[[eosio::action]]
+void wram::settlesell( const name owner, const asset balance, const asset min_out )
+{
+   require_auth(get_self());
+
+   const asset out = get_core_balance(balance.symbol) - balance;
+   check(out >= min_out, "sell ram output is below min_out");
+   if (out.amount == 0) { return; }
+
+   action(
+      permission_level{get_self(), "active"_n},
+      "eosio.token"_n,
+      "transfer"_n,
+      std::make_tuple(get_self(), owner, out, string("unwrap sell ram"))
+   ).send();
+}
+
+int64_t wram::unwrap_ram( const name to, const asset quantity, const int64_t balance )
+{
+   // update WRAM supply to reflect system RAM
+   const int64_t supply = mirror_system_ram(0, quantity.amount);
+
    // validate incoming token transfer
    check(quantity.symbol == RAM_SYMBOL, "Only the system " + RAM_SYMBOL.code().to_string() + " token is accepted for transfers.");
 
+   logunwrap_action logunwrap_act{get_self(), {get_self(), "active"_n}};
+   logunwrap_act.send(to, -quantity.amount, balance, supply, supply);
+
    // ramtransfer to user
    eosiosystem::system_contract::ramtransfer_action ramtransfer_act{"eosio"_n, {get_self(), "active"_n}};
    ramtransfer_act.send(get_self(), to, quantity.amount, "unwrap ram");
+   return supply;
+}
+
+// unwrap tokens credited to the contract, the contract balance is read after mirroring adjusted it
+wram::transfer_result wram::unwrap_result( const name to, const asset quantity, const int64_t balance )
+{
+   const int64_t supply = unwrap_ram( to, quantity, balance );
+   return { balance, eosiowram::get_balance( get_self(), get_self() ), supply, quantity.amount };
 }
 
 void wram::wrap_ram( const name to, const int64_t bytes )
 {
    // update WRAM supply to reflect system RAM
-   mirror_system_ram();
+   const int64_t supply = mirror_system_ram(bytes, 0);
 
    // cannot have contract itself mint WRAM
    check(to != get_self(), "cannot wrap ram to self" );
 
-   // transfer RAM tokens to user
+   // credit RAM tokens to user directly from the contract balance
    const asset quantity{bytes, RAM_SYMBOL};
-   transfer_action transfer_act{get_self(), {get_self(), "active"_n}};
-   transfer_act.send(get_self(), to, quantity, "wrap ram");
+   check( quantity.is_valid(), "invalid quantity" );
+   check( quantity.amount > 0, "must transfer positive quantity" );
+   const int64_t contract_balance = sub_balance( get_self(), quantity, get_self() );
+   const int64_t balance = add_balance( to, quantity, get_self() );
+
+   // log & notify user of the credit
+   logwrap_action logwrap_act{get_self(), {get_self(), "active"_n}};
+   logwrap_act.send(to, bytes, balance, supply, supply);
+
+   // disable transfers to accounts on egress list
+   check_disable_transfer( to );
+
+   // notification handlers have no dispatched return value, set it on the notification trace
+   auto result = pack( transfer_result{ contract_balance, balance, supply, bytes } );
+   internal_use_do_not_use::set_action_return_value( result.data(), result.size() );
 }
 
 [[eosio::on_notify("eosio::logbuyram")]]
@@ -46,22 +168,62 @@ void wram::on_logbuyram( const name& payer, const name& receiver, const asset& q
    wrap_ram(payer, bytes);
 }
 
+// peek the fixed-size `to` field of a `(name from, name to, ...)` notification from the action data
+// already read by the dispatcher, without copying it or moving the contract datastream
+name wram::get_notify_receiver()
+{
+   datastream<const char*> ds = get_datastream();
+   check( ds.remaining() >= 2 * sizeof(uint64_t), "invalid action data" );
+   ds.skip( sizeof(uint64_t) );
+
+   name to;
+   ds >> to;
+   return to;
+}
+
 // @user
 [[eosio::on_notify("eosio::ramtransfer")]]
-void wram::on_ramtransfer( const name from, const name to, const int64_t bytes, const string memo )
+void wram::on_ramtransfer()
 {
    // ignore transfers not sent to this contract
-   if (to != get_self()) { return; }
+   if (get_notify_receiver() != get_self()) { return; }
+
+   name from, to;
+   int64_t bytes;
+   string memo;
+   get_datastream() >> from >> to >> bytes >> memo;
    if (memo == "ignore") { return; } // allow for internal RAM transfers
-   wrap_ram(from, bytes);
+   wrap_ram(get_beneficiary(from, memo), bytes);
+}
+
+// `to:<account>` memo credits the wrapped RAM to `account`, any other memo credits `from`
+name wram::get_beneficiary( const name from, const string& memo )
+{
+   if (memo.rfind("to:", 0) != 0) { return from; }
+
+   // strict account name, no implicit truncation or trailing dots
+   const string account = memo.substr(3);
+   check(account.size() > 0 && account.size() <= 12, "invalid beneficiary memo");
+   for (const char c : account) {
+      check((c >= 'a' && c <= 'z') || (c >= '1' && c <= '5') || c == '.', "invalid beneficiary memo");
+   }
+   const name beneficiary{account};
+   check(beneficiary.to_string() == account, "invalid beneficiary memo");
+   check(is_account(beneficiary), "beneficiary account does not exist");
+   return beneficiary;
 }
 
 // @user
 [[eosio::on_notify("*::transfer")]]
-void wram::on_transfer( const name from, const name to, const asset quantity, const string memo )
+void wram::on_transfer()
 {
    // ignore transfers not sent to this contract
-   if (to != get_self()) { return; }
+   if (get_notify_receiver() != get_self()) { return; }
+
+   // allow `sellram` proceeds from `unwrapsell`
+   name from;
+   get_datastream() >> from;
+   if (get_first_receiver() == "eosio.token"_n && from == "eosio.ram"_n) { return; }
 
    // unwrap is triggered by internal transfer method
    check(false, "only " + get_self().to_string() + " token transfers are allowed");
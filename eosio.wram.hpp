@@ -2,24 +2,60 @@
 
 #include <eosio/eosio.hpp>
 #include <eosio.system/eosio.system.hpp>
+#include <eosio.wram/eosio.wram.hpp>
 #include <eosio/singleton.hpp>
 
 using namespace std;
 
+// hot path counters, compiled in with `-DWRAM_METRICS` only
+#ifdef WRAM_METRICS
+#define WRAM_METRIC( counter, value ) ( _metrics.counter += (value), _metrics_dirty = true )
+#else
+#define WRAM_METRIC( counter, value )
+#endif
+
 namespace eosio {
    /**
     * The `eosio.wram` contract is a contract that allows to wrap & unwrap system RAM at 1:1 using the `ramtransfer` method.
     */
    class [[eosio::contract("eosio.wram")]] wram : public contract {
-      const symbol RAM_SYMBOL = symbol("WRAM", 0);
+      static constexpr symbol RAM_SYMBOL = symbol(symbol_code("WRAM"), 0);
+      static constexpr uint64_t RAM_SYMBOL_CODE = RAM_SYMBOL.code().raw();
+      static constexpr uint64_t HISTORY_SIZE = 1024;
+      static constexpr uint32_t AUDIT_TIMEOUT = 7200; // block slots (1 hour) before an audit in progress can be restarted
 
       public:
          using contract::contract;
 
+         /**
+          * ## TABLE `egressset`
+          *
+          * > block transfers to any account in the egress set
+          *
+          * ### params
+          *
+          * - `{vector<name>} accounts` - sorted egress accounts not allowed to receive tokens
+          * - `{uint64_t} filter` - bloom filter of `accounts` for fast misses
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "accounts": ["eosio.ram"],
+          *     "filter": 268435456
+          * }
+          * ```
+          */
+         struct [[eosio::table("egressset")]] egressset_row {
+            vector<name>   accounts;
+            uint64_t       filter = 0;
+         };
+         typedef eosio::singleton< "egressset"_n, egressset_row > egressset;
+
          /**
           * ## TABLE `egresslist`
           *
-          * > block transfers to any account in the egress list
+          * > legacy egress list, folded into `egressset` by the next `addegress` or `removeegress`
           *
           * ### params
           *
@@ -40,6 +76,278 @@ namespace eosio {
          };
          typedef eosio::multi_index< "egresslist"_n, egresslist_row > egresslist;
 
+         /**
+          * ## TABLE `holders`
+          *
+          * > index of WRAM holders in a single scope, ordered by account & balance
+          * > holders are indexed when their balance changes, balances held since before the index are added by `index`
+          *
+          * ### params
+          *
+          * - `{name} owner` - holder account
+          * - `{int64_t} balance` - holder WRAM balance
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "owner": "alice",
+          *     "balance": 1000
+          * }
+          * ```
+          */
+         struct [[eosio::table("holders")]] holders_row {
+            name        owner;
+            int64_t     balance;
+
+            uint64_t primary_key()const { return owner.value; }
+            uint64_t by_balance()const { return balance; }
+         };
+         typedef eosio::multi_index< "holders"_n, holders_row,
+            indexed_by<"bybalance"_n, const_mem_fun<holders_row, uint64_t, &holders_row::by_balance>>
+         > holders;
+
+         /**
+          * ## TABLE `auditstate`
+          *
+          * > progress of the supply audit in progress, removed when the audit finishes
+          *
+          * ### params
+          *
+          * - `{name} next` - next holder to visit
+          * - `{int64_t} balances` - sum of the visited balances, adjusted when a visited balance changes
+          * - `{uint32_t} holders` - number of visited holders
+          * - `{uint32_t} mismatches` - visited holders whose index balance differs from their balance row
+          * - `{block_timestamp} updated` - time of the last `audit` call
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "next": "bob",
+          *     "balances": 1000,
+          *     "holders": 1,
+          *     "mismatches": 0,
+          *     "updated": "2024-04-09T00:00:00.000"
+          * }
+          * ```
+          */
+         struct [[eosio::table("auditstate")]] auditstate_row {
+            name              next;
+            int64_t           balances = 0;
+            uint32_t          holders = 0;
+            uint32_t          mismatches = 0;
+            block_timestamp   updated;
+         };
+         typedef eosio::singleton< "auditstate"_n, auditstate_row > auditstate;
+
+         /**
+          * ## TABLE `auditresult`
+          *
+          * > result of the last finished supply audit
+          *
+          * ### params
+          *
+          * - `{int64_t} balances` - sum of all holder balances
+          * - `{int64_t} supply` - WRAM supply
+          * - `{int64_t} total_ram_bytes_reserved` - system RAM reserved bytes
+          * - `{uint32_t} holders` - number of holders
+          * - `{uint32_t} mismatches` - holders whose index balance differs from their balance row
+          * - `{bool} balanced` - balances equal supply, supply equals reserved bytes & no mismatches
+          * - `{block_timestamp} completed` - time the audit finished
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "balances": 321908101425,
+          *     "supply": 321908101425,
+          *     "total_ram_bytes_reserved": 321908101425,
+          *     "holders": 3,
+          *     "mismatches": 0,
+          *     "balanced": true,
+          *     "completed": "2024-04-01T00:00:00.000"
+          * }
+          * ```
+          */
+         struct [[eosio::table("auditresult")]] auditresult_row {
+            int64_t           balances;
+            int64_t           supply;
+            int64_t           total_ram_bytes_reserved;
+            uint32_t          holders;
+            uint32_t          mismatches;
+            bool              balanced;
+            block_timestamp   completed;
+         };
+         typedef eosio::singleton< "auditresult"_n, auditresult_row > auditresult;
+
+         /**
+          * ## TABLE `config`
+          *
+          * > contract settings, changed by `setconfig`
+          *
+          * ### params
+          *
+          * - `{bool} auto_reap` - erase balance rows drained to zero & allow `reap`
+          * - `{bool} compact_balances` - open new balances as compact `balances` rows & allow `migrate`, legacy `accounts` rows otherwise
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "auto_reap": true,
+          *     "compact_balances": false
+          * }
+          * ```
+          */
+         struct [[eosio::table("config")]] config_row {
+            bool     auto_reap = false;
+            bool     compact_balances = false;
+         };
+         typedef eosio::singleton< "config"_n, config_row > config;
+
+         /**
+          * ## TABLE `allowances`
+          *
+          * > WRAM `owner` allows `spender` to transfer with `transferfrom`, scoped by owner
+          *
+          * ### params
+          *
+          * - `{name} spender` - account allowed to transfer from the owner
+          * - `{int64_t} amount` - remaining WRAM the spender may transfer
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "spender": "dex",
+          *     "amount": 1000
+          * }
+          * ```
+          */
+         struct [[eosio::table("allowances")]] allowances_row {
+            name        spender;
+            int64_t     amount;
+
+            uint64_t primary_key()const { return spender.value; }
+         };
+         typedef eosio::multi_index< "allowances"_n, allowances_row > allowances;
+
+         /**
+          * ## TABLE `history`
+          *
+          * > ring buffer of supply & system RAM records, one per block with a wrap, unwrap or mirror
+          *
+          * ### params
+          *
+          * - `{uint64_t} seq` - record sequence number, the row is reused by `seq + 1024`
+          * - `{block_timestamp} time` - block of the record
+          * - `{int64_t} supply` - WRAM supply at the end of the block
+          * - `{int64_t} total_ram_bytes_reserved` - system RAM reserved bytes at the end of the block
+          * - `{int64_t} wrapped` - cumulative WRAM wrapped (bytes)
+          * - `{int64_t} unwrapped` - cumulative WRAM unwrapped (bytes)
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "seq": 42,
+          *     "time": "2024-04-01T00:00:00.000",
+          *     "supply": 321908101425,
+          *     "total_ram_bytes_reserved": 321908101425,
+          *     "wrapped": 5000,
+          *     "unwrapped": 1200
+          * }
+          * ```
+          */
+         struct [[eosio::table("history")]] history_row {
+            uint64_t          seq;
+            block_timestamp   time;
+            int64_t           supply;
+            int64_t           total_ram_bytes_reserved;
+            int64_t           wrapped;
+            int64_t           unwrapped;
+
+            uint64_t primary_key()const { return seq % HISTORY_SIZE; }
+         };
+         typedef eosio::multi_index< "history"_n, history_row > history;
+
+         /**
+          * ## TABLE `historystate`
+          *
+          * > next `history` sequence number to write
+          *
+          * ### params
+          *
+          * - `{uint64_t} next` - sequence number of the next record
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "next": 43
+          * }
+          * ```
+          */
+         struct [[eosio::table("historystate")]] historystate_row {
+            uint64_t    next = 0;
+         };
+         typedef eosio::singleton< "historystate"_n, historystate_row > historystate;
+
+#ifdef WRAM_METRICS
+         /**
+          * ## TABLE `metrics`
+          *
+          * > hot path counters, only maintained by builds with `-DWRAM_METRICS`
+          *
+          * ### params
+          *
+          * - `{uint64_t} mirror_issues` - supply adjustments issuing WRAM
+          * - `{uint64_t} mirror_retires` - supply adjustments retiring WRAM
+          * - `{uint64_t} mirror_issued` - total WRAM issued by supply adjustments
+          * - `{uint64_t} mirror_retired` - total WRAM retired by supply adjustments
+          * - `{uint64_t} egress_checks` - egress checks of receivers other than the contract
+          * - `{uint64_t} egress_searches` - egress checks not rejected by the bloom filter
+          * - `{uint64_t} balance_emplaces` - credits creating a new balance row
+          * - `{uint64_t} balance_modifies` - credits modifying an existing balance row
+          *
+          * ### example
+          *
+          * ```json
+          * {
+          *     "mirror_issues": 12,
+          *     "mirror_retires": 3,
+          *     "mirror_issued": 120000,
+          *     "mirror_retired": 4096,
+          *     "egress_checks": 530,
+          *     "egress_searches": 2,
+          *     "balance_emplaces": 40,
+          *     "balance_modifies": 610
+          * }
+          * ```
+          */
+         struct [[eosio::table("metrics")]] metrics_row {
+            uint64_t    mirror_issues = 0;
+            uint64_t    mirror_retires = 0;
+            uint64_t    mirror_issued = 0;
+            uint64_t    mirror_retired = 0;
+            uint64_t    egress_checks = 0;
+            uint64_t    egress_searches = 0;
+            uint64_t    balance_emplaces = 0;
+            uint64_t    balance_modifies = 0;
+         };
+         typedef eosio::singleton< "metrics"_n, metrics_row > metrics;
+
+         // counters of the action are added to the `metrics` table when the contract is destroyed
+         ~wram();
+
+         /**
+          * Get the hot path counters (read-only), only available in builds with `-DWRAM_METRICS`.
+          */
+         [[eosio::action, eosio::read_only]]
+         metrics_row getmetrics();
+#endif
+
          /**
           * Add accounts to the egress list.
           *
@@ -56,20 +364,77 @@ namespace eosio {
          [[eosio::action]]
          void removeegress( const set<name> accounts );
 
+         /**
+          * Post-state returned by `transfer`, `transferfrom` & `unwrap`, and by the wrap notifications (`ramtransfer`, `logbuyram`)
+          *
+          * - `{int64_t} from_balance` - sender WRAM balance after the action (the contract when wrapping)
+          * - `{int64_t} to_balance` - receiver WRAM balance after the action (the contract when unwrapping)
+          * - `{int64_t} supply` - WRAM supply after the action
+          * - `{int64_t} bytes` - WRAM (bytes) moved
+          */
+         struct transfer_result {
+            int64_t     from_balance;
+            int64_t     to_balance;
+            int64_t     supply;
+            int64_t     bytes;
+         };
+
          /**
           * Unwrap WRAM tokens to system RAM `bytes`
           *
           * @param owner - the account to unwrap WRAM tokens from,
           * @param bytes - the amount of system RAM to unwrap.
+          *
+          * @return the balances & supply after the action.
+          */
+         [[eosio::action]]
+         transfer_result unwrap( const name owner, const int64_t bytes );
+
+         /**
+          * Unwrap WRAM tokens from `owner` and sell the system RAM `bytes` in a single action.
+          * The core token proceeds actually paid by `sellram` (after the 0.5% RAM fee) are sent to `owner` by `settlesell`.
+          *
+          * @param owner - the account to unwrap WRAM tokens from,
+          * @param bytes - the amount of system RAM to unwrap & sell,
+          * @param min_out - the minimum core tokens to receive (slippage bound).
           */
          [[eosio::action]]
-         void unwrap( const name owner, const int64_t bytes );
+         void unwrapsell( const name owner, const int64_t bytes, const asset min_out );
+
+         /**
+          * Send the `sellram` proceeds of `unwrapsell` to `owner`, inline after `sellram` (contract only).
+          * The proceeds are the contract core token balance above `balance`, the balance before `sellram`.
+          *
+          * @param owner - the account receiving the proceeds,
+          * @param balance - the contract core token balance before `sellram`,
+          * @param min_out - the minimum core tokens to receive (slippage bound).
+          */
+         [[eosio::action]]
+         void settlesell( const name owner, const asset balance, const asset min_out );
+
+         struct unwrap_params {
+            name     to;
+            int64_t  bytes;
+         };
+
+         /**
+          * Unwrap WRAM tokens from `owner` to system RAM `bytes` of many `recipients`.
+          * `owner` is debited once with the total and supply is mirrored once.
+          *
+          * @param owner - the account to unwrap WRAM tokens from,
+          * @param recipients - the accounts and amounts of system RAM to unwrap to.
+          */
+         [[eosio::action]]
+         void unwrapto( const name owner, const vector<unwrap_params> recipients );
 
          /**
           * Send system RAM `bytes` to contract to issue `RAM` tokens to sender.
+          * A `to:<account>` memo issues the tokens to the existing `account` instead, `ignore` issues no tokens.
+          *
+          * Action data `(name from, name to, int64_t bytes, string memo)` is only decoded when `to` is this contract.
           */
          [[eosio::on_notify("eosio::ramtransfer")]]
-         void on_ramtransfer(const name from, const name to, const int64_t bytes, const string memo);
+         void on_ramtransfer();
 
          /**
           * Buy system RAM `bytes` to contract to issue `RAM` tokens to payer.
@@ -77,11 +442,51 @@ namespace eosio {
          [[eosio::on_notify("eosio::logbuyram")]]
          void on_logbuyram( const name& payer, const name& receiver, const asset& quantity, int64_t bytes, int64_t ram_bytes );
 
+         /**
+          * Log WRAM wrapped to `account`.
+          *
+          * All log actions share the same fixed-size layout.
+          *
+          * @param account - the account credited with WRAM,
+          * @param delta - the change of `account` WRAM balance (positive),
+          * @param balance - the `account` WRAM balance after the action,
+          * @param supply - the WRAM supply after the action,
+          * @param total_ram_bytes_reserved - the system RAM reserved bytes after the action.
+          */
+         [[eosio::action]]
+         void logwrap( const name account, const int64_t delta, const int64_t balance, const int64_t supply, const int64_t total_ram_bytes_reserved );
+
+         /**
+          * Log WRAM unwrapped from `account`.
+          *
+          * @param account - the account debited of WRAM,
+          * @param delta - the change of `account` WRAM balance (negative),
+          * @param balance - the `account` WRAM balance after the action,
+          * @param supply - the WRAM supply after the action,
+          * @param total_ram_bytes_reserved - the system RAM reserved bytes after the action.
+          */
+         [[eosio::action]]
+         void logunwrap( const name account, const int64_t delta, const int64_t balance, const int64_t supply, const int64_t total_ram_bytes_reserved );
+
+         /**
+          * Log WRAM supply mirrored to system RAM.
+          *
+          * @param account - the contract account holding issued WRAM,
+          * @param delta - the amount of WRAM issued (positive) or retired (negative),
+          * @param balance - the contract WRAM balance after the action,
+          * @param supply - the WRAM supply after the action,
+          * @param total_ram_bytes_reserved - the system RAM reserved bytes after the action.
+          */
+         [[eosio::action]]
+         void logmirror( const name account, const int64_t delta, const int64_t balance, const int64_t supply, const int64_t total_ram_bytes_reserved );
+
          /**
           * Disallow sending tokens to this contract.
+          *
+          * Action data `(name from, name to, asset quantity, string memo)` is only decoded when `to` is this contract.
           */
          [[eosio::on_notify("*::transfer")]]
-         void on_transfer(const name from, const name to, const asset quantity, const string memo);
+         void on_transfer();
 
          /**
           * Allows `issuer` account to create a token in supply of `maximum_supply`. If validation is successful a new entry in statstable for token symbol scope gets created.
@@ -125,12 +530,56 @@ namespace eosio {
           * @param to - the account to be transferred to,
           * @param quantity - the quantity of tokens to be transferred,
           * @param memo - the memo string to accompany the transaction.
+          *
+          * @return the balances & supply after the action.
+          */
+         [[eosio::action]]
+         transfer_result transfer( const name&    from,
+                                   const name&    to,
+                                   const asset&   quantity,
+                                   const string&  memo );
+
+         struct transfer_params {
+            name     to;
+            asset    quantity;
+            string   memo;
+         };
+
+         /**
+          * Allows `from` account to transfer tokens to many `transfers` recipients in a single action.
+          * `from` is debited once with the total and each recipient is credited with its quantity.
+          *
+          * @param from - the account to transfer from,
+          * @param transfers - the recipients, quantities and memos to be transferred.
+          */
+         [[eosio::action]]
+         void transfers( const name& from, const vector<transfer_params>& transfers );
+
+         /**
+          * Allows `spender` to transfer up to `amount` WRAM tokens of `owner` with `transferfrom`.
+          * Replaces any previous allowance, a zero `amount` removes it. RAM is paid by `owner`.
+          *
+          * @param owner - the account allowing the transfers,
+          * @param spender - the account allowed to transfer,
+          * @param amount - the maximum amount of WRAM tokens to be transferred.
           */
          [[eosio::action]]
-         void transfer( const name&    from,
-                        const name&    to,
-                        const asset&   quantity,
-                        const string&  memo );
+         void approve( const name& owner, const name& spender, const int64_t amount );
+
+         /**
+          * Allows `spender` to transfer `quantity` tokens from `from` to `to`, within the allowance of `from`.
+          * Follows the same rules as `transfer`, tokens sent to the contract are unwrapped to `from`.
+          *
+          * @param spender - the account allowed to transfer,
+          * @param from - the account to transfer from,
+          * @param to - the account to be transferred to,
+          * @param quantity - the quantity of tokens to be transferred.
+          *
+          * @return the balances & supply after the action.
+          */
+         [[eosio::action]]
+         transfer_result transferfrom( const name& spender, const name& from, const name& to, const asset& quantity );
+
          /**
           * Allows `ram_payer` to create an account `owner` with zero balance for
           * token `symbol` at the expense of `ram_payer`.
@@ -158,6 +607,75 @@ namespace eosio {
          [[eosio::action]]
          void close( const name& owner, const symbol& symbol );
 
+         /**
+          * Migrate legacy `accounts` balance rows of `owners` to the compact `balances` row format once `compact_balances` is enabled.
+          * Requires the authority of every owner, who pays the RAM of its compact row, or of the contract, which pays it instead.
+          * Owners without a legacy row are skipped. Migrated balances are no longer visible to `accounts` table readers.
+          *
+          * @param owners - the owner accounts to migrate (at most 100 per action).
+          */
+         [[eosio::action]]
+         void migrate( const vector<name> owners );
+
+         /**
+          * Add the balances of `owners` held since before the `holders` index (legacy or compact rows) to the index (permissionless).
+          * Owners already indexed or without a balance row are skipped, works whether or not `compact_balances` is enabled.
+          *
+          * @param payer - the account paying the RAM of the new index rows,
+          * @param owners - the owner accounts to index (at most 100 per action).
+          *
+          * @return the number of owners indexed.
+          */
+         [[eosio::action]]
+         uint32_t index( const name payer, const vector<name> owners );
+
+         /**
+          * Set the contract settings.
+          *
+          * @param auto_reap - erase balance rows drained to zero, returning their RAM to the payer,
+          * @param compact_balances - open new balances as compact `balances` rows & allow `migrate`.
+          *
+          * Enabling `compact_balances` breaks readers of the legacy `accounts` table: compact balances are not returned by
+          * `get_currency_balance`, nor seen by wallets, explorers & exchanges that read `accounts` rows, until they read `balances`.
+          */
+         [[eosio::action]]
+         void setconfig( const bool auto_reap, const bool compact_balances );
+
+         /**
+          * Erase up to `limit` balance rows of holders with a zero balance, returning their RAM to the payer (permissionless).
+          * Requires `auto_reap` to be enabled, zero balances are visited first using the `bybalance` index.
+          * Balance rows not indexed (legacy rows drained before the upgrade, rows opened but never credited)
+          * are reaped by listing their owners in `owners`, owners with a non-zero or missing row are skipped.
+          *
+          * @param limit - the maximum number of indexed balance rows to erase (at most 1000),
+          * @param owners - the owner accounts whose zero balance rows are erased directly (at most 100).
+          *
+          * @return the number of balance rows erased.
+          */
+         [[eosio::action]]
+         uint32_t reap( const uint32_t limit, const vector<name> owners );
+
+         struct balance_result {
+            name     owner;
+            asset    balance;
+         };
+
+         struct getbalances_result {
+            vector<balance_result>  balances;
+            asset                   supply;
+            int64_t                 total_ram_bytes_reserved;
+            int64_t                 max_ram_size;
+         };
+
+         /**
+          * Get WRAM balances of `owners` with the current supply and mirrored system RAM (read-only).
+          * Owners without a balance row are returned with a zero balance.
+          *
+          * @param owners - the accounts to get balances of.
+          */
+         [[eosio::action, eosio::read_only]]
+         getbalances_result getbalances( const vector<name> owners );
+
          static asset get_supply( const name& token_contract_account, const symbol_code& sym_code )
          {
             stats statstable( token_contract_account, sym_code.raw() );
@@ -165,26 +683,165 @@ namespace eosio {
             return st.supply;
          }
 
-         static asset get_balance( const name& token_contract_account, const name& owner, const symbol_code& sym_code )
+         struct history_result {
+            vector<history_row>  records;
+            uint64_t             next;
+         };
+
+         /**
+          * Get up to `limit` `history` records starting at sequence number `from` (read-only).
+          * Records overwritten by the ring buffer are skipped, `next` is the sequence number to continue from.
+          *
+          * @param from - the first record sequence number,
+          * @param limit - the maximum number of records to return (at most 1000).
+          */
+         [[eosio::action, eosio::read_only]]
+         history_result gethistory( const uint64_t from, const uint32_t limit );
+
+         struct listholders_result {
+            vector<holders_row>  holders;
+            name                 next;
+         };
+
+         /**
+          * List WRAM holders ordered by account, starting at `cursor` (read-only).
+          * Balances held since before the `holders` index are only listed once backfilled by `index`.
+          *
+          * @param cursor - the first holder account to list (empty to start from the beginning),
+          * @param limit - the maximum number of holders to list (at most 1000).
+          *
+          * @return holders and `next` cursor (empty when there are no more holders).
+          */
+         [[eosio::action, eosio::read_only]]
+         listholders_result listholders( const name cursor, const uint32_t limit );
+
+         /**
+          * List the `n` largest WRAM holders ordered by balance descending (read-only).
+          * Balances held since before the `holders` index are only listed once backfilled by `index`.
+          *
+          * @param n - the number of holders to list (at most 1000).
+          */
+         [[eosio::action, eosio::read_only]]
+         vector<holders_row> topholders( const uint32_t n );
+
+         struct audit_result {
+            name        next;
+            int64_t     balances;
+            uint32_t    holders;
+            uint32_t    mismatches;
+            bool        balanced;
+         };
+
+         /**
+          * Audit that the sum of all holder balances equals the WRAM supply, and that the supply equals
+          * the system `total_ram_bytes_reserved`, walking `limit` holders per call (permissionless).
+          * Partial sums are kept in `auditstate` between calls, the result of the finished walk is stored in `auditresult`.
+          * Balances changed after being visited are adjusted. Balances held since before the holder index are not visited,
+          * so `balanced` stays false until they are backfilled with `index`.
+          *
+          * An empty cursor starts a new audit, it is rejected while an audit is in progress unless the audit was not
+          * continued for `AUDIT_TIMEOUT` block slots or the contract itself restarts it.
+          *
+          * @param cursor - the `next` holder returned by the previous call (empty to start a new audit),
+          * @param limit - the maximum number of holders to visit (at most 1000).
+          *
+          * @return progress of the audit, `next` is empty and `balanced` is set when the audit finished.
+          */
+         [[eosio::action]]
+         audit_result audit( const name cursor, const uint32_t limit );
+
+         /**
+          * Quote the WRAM received when wrapping by `buyram` with `quantity` (read-only).
+          * Uses the system RAM market (`rammarket`) after the 0.5% RAM fee.
+          *
+          * @param quantity - the quantity of core tokens to buy RAM with.
+          *
+          * @return the WRAM (bytes) received.
+          */
+         [[eosio::action, eosio::read_only]]
+         asset quotewrap( const asset quantity );
+
+         /**
+          * Quote the core tokens received when unwrapping & selling `bytes` of WRAM (read-only).
+          * Uses the system RAM market (`rammarket`) after the 0.5% RAM fee.
+          *
+          * @param bytes - the amount of WRAM (bytes) to unwrap & sell.
+          *
+          * @return the core tokens received.
+          */
+         [[eosio::action, eosio::read_only]]
+         asset quotesell( const int64_t bytes );
+
+         static std::optional<asset> find_balance( const name& token_contract_account, const name& owner, const symbol_code& sym_code )
          {
+            // compact balance row
+            balances balancestable( token_contract_account, owner.value );
+            const auto bal = balancestable.find( sym_code.raw() );
+            if ( bal != balancestable.end() ) return asset{ bal->amount, RAM_SYMBOL };
+
+            // legacy balance row (not yet migrated)
             accounts accountstable( token_contract_account, owner.value );
-            const auto& ac = accountstable.get( sym_code.raw(), "no balance with specified symbol" );
-            return ac.balance;
+            const auto ac = accountstable.find( sym_code.raw() );
+            if ( ac != accountstable.end() ) return ac->balance;
+            return {};
+         }
+
+         static asset get_balance( const name& token_contract_account, const name& owner, const symbol_code& sym_code )
+         {
+            const auto balance = find_balance( token_contract_account, owner, sym_code );
+            check( balance.has_value(), "no balance with specified symbol" );
+            return *balance;
          }
 
          using create_action = eosio::action_wrapper<"create"_n, &wram::create>;
          using issue_action = eosio::action_wrapper<"issue"_n, &wram::issue>;
          using retire_action = eosio::action_wrapper<"retire"_n, &wram::retire>;
          using transfer_action = eosio::action_wrapper<"transfer"_n, &wram::transfer>;
+         using transfers_action = eosio::action_wrapper<"transfers"_n, &wram::transfers>;
+         using approve_action = eosio::action_wrapper<"approve"_n, &wram::approve>;
+         using transferfrom_action = eosio::action_wrapper<"transferfrom"_n, &wram::transferfrom>;
          using open_action = eosio::action_wrapper<"open"_n, &wram::open>;
          using close_action = eosio::action_wrapper<"close"_n, &wram::close>;
+         using migrate_action = eosio::action_wrapper<"migrate"_n, &wram::migrate>;
+         using setconfig_action = eosio::action_wrapper<"setconfig"_n, &wram::setconfig>;
+         using index_action = eosio::action_wrapper<"index"_n, &wram::index>;
+         using reap_action = eosio::action_wrapper<"reap"_n, &wram::reap>;
+         using getbalances_action = eosio::action_wrapper<"getbalances"_n, &wram::getbalances>;
+         using listholders_action = eosio::action_wrapper<"listholders"_n, &wram::listholders>;
+         using topholders_action = eosio::action_wrapper<"topholders"_n, &wram::topholders>;
+         using audit_action = eosio::action_wrapper<"audit"_n, &wram::audit>;
+         using gethistory_action = eosio::action_wrapper<"gethistory"_n, &wram::gethistory>;
+         using quotewrap_action = eosio::action_wrapper<"quotewrap"_n, &wram::quotewrap>;
+         using quotesell_action = eosio::action_wrapper<"quotesell"_n, &wram::quotesell>;
+         using unwrapsell_action = eosio::action_wrapper<"unwrapsell"_n, &wram::unwrapsell>;
+         using settlesell_action = eosio::action_wrapper<"settlesell"_n, &wram::settlesell>;
+         using logwrap_action = eosio::action_wrapper<"logwrap"_n, &wram::logwrap>;
+         using logunwrap_action = eosio::action_wrapper<"logunwrap"_n, &wram::logunwrap>;
+         using logmirror_action = eosio::action_wrapper<"logmirror"_n, &wram::logmirror>;
+#ifdef WRAM_METRICS
+         using getmetrics_action = eosio::action_wrapper<"getmetrics"_n, &wram::getmetrics>;
+#endif
       private:
+         // `max_ram_size` & `total_ram_bytes_reserved` decoded from the system `global` row
+         struct global_ram {
+            int64_t  max_ram_size;
+            int64_t  total_ram_bytes_reserved;
+         };
+
+         // legacy balance row, superseded by `balance`
          struct [[eosio::table]] account {
             asset    balance;
 
             uint64_t primary_key()const { return balance.symbol.code().raw(); }
          };
 
+         // compact balance row (symbol is always WRAM)
+         struct [[eosio::table]] balance {
+            int64_t  amount;
+
+            uint64_t primary_key()const { return RAM_SYMBOL_CODE; }
+         };
+
          struct [[eosio::table]] currency_stats {
             asset    supply;
             asset    max_supply;
@@ -194,15 +851,42 @@ namespace eosio {
          };
 
          typedef eosio::multi_index< "accounts"_n, account > accounts;
+         typedef eosio::multi_index< "balances"_n, balance > balances;
          typedef eosio::multi_index< "stat"_n, currency_stats > stats;
 
-         void unwrap_ram( const name to, const asset quantity );
+         int64_t unwrap_ram( const name to, const asset quantity, const int64_t balance );
+         transfer_result unwrap_result( const name to, const asset quantity, const int64_t balance );
          void wrap_ram( const name to, const int64_t bytes );
-         void mirror_system_ram();
+         int64_t mirror_system_ram( const int64_t wrapped = 0, const int64_t unwrapped = 0 );
+         void update_history( const int64_t supply, const int64_t total_ram_bytes_reserved, const int64_t wrapped, const int64_t unwrapped );
          eosiosystem::system_contract::eosio_global_state get_global();
+         global_ram get_global_ram();
+         asset quote_buyram( const asset& quantity );
+         asset quote_sellram( const int64_t bytes );
+         asset get_core_balance( const symbol& sym );
          void check_disable_transfer( const name receiver );
+         void check_disable_transfer( const name receiver, const std::optional<egressset_row>& egress );
+         std::optional<egressset_row> get_egress_row();
+         set<name> get_egress_accounts();
+         void set_egress_accounts( const set<name>& accounts );
+         name get_notify_receiver();
+         name get_beneficiary( const name from, const string& memo );
+
+         int64_t sub_balance( const name& owner, const asset& value, const name& ram_payer );
+         int64_t add_balance( const name& owner, const asset& value, const name& ram_payer );
+         void set_holder( const name& owner, const int64_t balance, const name& ram_payer );
+         void erase_holder( const name& owner );
+         bool reap_drained( const name& owner );
+         bool reap_balance( const name& owner );
+         bool compact_balances();
+         void audit_balance_changed( const name& owner, const int64_t delta );
+
+         // whether an audit is in progress, read once per action by the first balance change
+         std::optional<bool> _auditing;
 
-         void sub_balance( const name& owner, const asset& value );
-         void add_balance( const name& owner, const asset& value, const name& ram_payer );
+#ifdef WRAM_METRICS
+         metrics_row _metrics;
+         bool _metrics_dirty = false;
+#endif
    };
 } /// namespace eosio
@@ -66,6 +66,15 @@ public:
     {
         add_ram(account, -bytes);
         reserve_ram(-bytes);
+
+        // pay a flat 0.0001 EOS per byte from `eosio.ram`, below the RAM market price of `quotesell`
+        if (bytes <= 0) return;
+        action(
+            permission_level{"eosio.ram"_n, "active"_n},
+            "eosio.token"_n,
+            "transfer"_n,
+            std::make_tuple("eosio.ram"_n, account, asset{bytes, symbol("EOS", 4)}, std::string("sell ram"))
+        ).send();
     }
 
     /**
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Header-only client of the `eosio.wram` contract for integrating contracts.
+ *
+ * Balances & supply are read through the raw db API, decoding only the leading `int64` amount
+ * of each row instead of deserializing a full `asset` through a `multi_index`.
+ */
+namespace eosiowram {
+
+   using eosio::name;
+   using eosio::asset;
+   using eosio::symbol;
+   using eosio::symbol_code;
+
+   static constexpr name WRAM_CONTRACT = name("eosio.wram");
+   static constexpr symbol RAM_SYMBOL = symbol(symbol_code("WRAM"), 0);
+
+   namespace detail {
+      // leading `int64` amount of a row: `balances` (int64), `accounts` & `stat` (asset first)
+      inline std::optional<int64_t> read_amount( const name& code, const uint64_t scope, const name& table )
+      {
+         const uint64_t pk = RAM_SYMBOL.code().raw();
+         const int32_t itr = eosio::internal_use_do_not_use::db_find_i64( code.value, scope, table.value, pk );
+         if ( itr < 0 ) return {};
+
+         int64_t amount = 0;
+         const int32_t size = eosio::internal_use_do_not_use::db_get_i64( itr, &amount, sizeof(amount) );
+         eosio::check( size == sizeof(amount), "invalid WRAM row" );
+         return amount;
+      }
+   }
+
+   /**
+    * Get the WRAM balance of `owner`, empty when `owner` has no balance row (does not throw).
+    *
+    * @param owner - the account to get the balance of,
+    * @param contract - the WRAM token contract.
+    */
+   inline std::optional<int64_t> try_get_balance( const name& owner, const name& contract = WRAM_CONTRACT )
+   {
+      // compact balance row, then legacy balance row (not yet migrated)
+      const auto amount = detail::read_amount( contract, owner.value, name("balances") );
+      if ( amount ) return amount;
+      return detail::read_amount( contract, owner.value, name("accounts") );
+   }
+
+   /**
+    * Get the WRAM balance of `owner`, zero when `owner` has no balance row.
+    *
+    * @param owner - the account to get the balance of,
+    * @param contract - the WRAM token contract.
+    */
+   inline int64_t get_balance( const name& owner, const name& contract = WRAM_CONTRACT )
+   {
+      return try_get_balance( owner, contract ).value_or( 0 );
+   }
+
+   /**
+    * Get the WRAM balances of `owners` in the same order, zero for owners without a balance row.
+    *
+    * @param owners - the accounts to get the balances of,
+    * @param contract - the WRAM token contract.
+    */
+   inline std::vector<int64_t> get_balances( const std::vector<name>& owners, const name& contract = WRAM_CONTRACT )
+   {
+      std::vector<int64_t> balances;
+      balances.reserve( owners.size() );
+      for ( const name& owner : owners ) {
+         balances.push_back( get_balance( owner, contract ) );
+      }
+      return balances;
+   }
+
+   /**
+    * Get the WRAM supply, equal to the system `total_ram_bytes_reserved` after the last wrap or unwrap.
+    *
+    * @param contract - the WRAM token contract.
+    */
+   inline int64_t get_supply( const name& contract = WRAM_CONTRACT )
+   {
+      const auto supply = detail::read_amount( contract, RAM_SYMBOL.code().raw(), name("stat") );
+      eosio::check( supply.has_value(), "invalid supply symbol code" );
+      return *supply;
+   }
+
+   /**
+    * Send an inline WRAM `transfer` of `bytes` from `from` to `to`, authorized by `from@active`.
+    *
+    * @param from - the account to transfer from,
+    * @param to - the account to be transferred to,
+    * @param bytes - the amount of WRAM to transfer,
+    * @param memo - the memo string to accompany the transaction,
+    * @param contract - the WRAM token contract.
+    */
+   inline void transfer( const name& from, const name& to, const int64_t bytes, const std::string& memo, const name& contract = WRAM_CONTRACT )
+   {
+      eosio::action( eosio::permission_level{ from, name("active") }, contract, name("transfer"),
+                     std::make_tuple( from, to, asset{ bytes, RAM_SYMBOL }, memo ) ).send();
+   }
+
+   /**
+    * Send an inline WRAM `unwrap` of `bytes` from `owner` to system RAM, authorized by `owner@active`.
+    *
+    * @param owner - the account to unwrap WRAM tokens from,
+    * @param bytes - the amount of system RAM to unwrap,
+    * @param contract - the WRAM token contract.
+    */
+   inline void unwrap( const name& owner, const int64_t bytes, const name& contract = WRAM_CONTRACT )
+   {
+      eosio::action( eosio::permission_level{ owner, name("active") }, contract, name("unwrap"),
+                     std::make_tuple( owner, bytes ) ).send();
+   }
+
+} /// namespace eosiowram
@@ -0,0 +1,372 @@
+/**
+ * Native microbenchmarks of the `eosio.wram` hot paths.
+ *
+ * The contract is compiled as-is against the in-memory CDT stand-ins in `native/include`,
+ * each action handler is invoked directly with its action context (receiver, authorizations,
+ * action data) set on the native chain state. Inline actions are captured but not executed.
+ *
+ * Counters (rows read & written, inline actions, RAM billed) are deterministic and compared
+ * against a baseline file to catch cost regressions, timings are only compared when a
+ * tolerance is given as they depend on the host.
+ *
+ * Usage: wram_bench [--quick] [--iterations N] [--filter substring]
+ *                   [--baseline file] [--write-baseline file] [--time-tolerance percent]
+ */
+#include "eosio.wram.cpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace eosio;
+
+namespace {
+
+   constexpr name CONTRACT = "eosio.wram"_n;
+   constexpr name SYSTEM = "eosio"_n;
+   constexpr symbol WRAM = symbol( symbol_code("WRAM"), 0 );
+   constexpr symbol EOS = symbol( symbol_code("EOS"), 4 );
+
+   constexpr int64_t MAX_RAM_SIZE = 418945440768;
+   constexpr int64_t TOTAL_RAM_BYTES_RESERVED = 321908101425;
+
+   // scale of the benchmark state
+   constexpr uint32_t HOLDERS = 2000;
+   constexpr uint32_t EGRESS_ACCOUNTS = 256;
+
+   // counters are measured over a fixed number of operations so they do not depend on `--iterations`
+   constexpr uint64_t PROBE_OPS = 256;
+
+   struct result {
+      std::string name;
+      uint64_t    iterations;
+      double      ns_per_op;
+      double      db_reads;
+      double      db_writes;
+      double      inline_actions;
+      double      ram_bytes;
+   };
+
+   // invoke an action handler of `eosio.wram` as received from `first_receiver`
+   template<typename Handler>
+   void apply( name first_receiver, std::vector<name> auths, std::vector<char> data, Handler&& handler ) {
+      auto& s = native::state();
+      s.begin_action( CONTRACT, first_receiver, std::move(auths), std::move(data) );
+      wram contract( CONTRACT, first_receiver, datastream<const char*>( s.action_data.data(), s.action_data.size() ) );
+      handler( contract );
+   }
+
+   template<typename Handler>
+   void apply( name auth, Handler&& handler ) {
+      apply( CONTRACT, { auth }, {}, std::forward<Handler>(handler) );
+   }
+
+   eosiosystem::system_contract::eosio_global_state get_system_global() {
+      eosiosystem::system_contract::global_state_singleton global( SYSTEM, SYSTEM.value );
+      return global.get();
+   }
+
+   void set_system_global( const eosiosystem::system_contract::eosio_global_state& state ) {
+      eosiosystem::system_contract::global_state_singleton global( SYSTEM, SYSTEM.value );
+      global.set( state, SYSTEM );
+   }
+
+   // wrap `bytes` of RAM to `owner` as if sent using `eosio::ramtransfer`
+   void wrap( name owner, int64_t bytes ) {
+      apply( SYSTEM, { owner }, pack( std::make_tuple( owner, CONTRACT, bytes, std::string() ) ), []( wram& c ) {
+         c.on_ramtransfer();
+      });
+   }
+
+   // `prefix` followed by `i` in base 26 letters
+   name account_name( const char* prefix, uint32_t i, uint32_t letters = 4 ) {
+      std::string str = prefix;
+      for ( uint32_t n = letters; n > 0; --n ) {
+         uint32_t div = 1;
+         for ( uint32_t k = 1; k < n; ++k ) div *= 26;
+         str += char( 'a' + (i / div) % 26 );
+      }
+      return name( str );
+   }
+
+   name holder( uint32_t i ) { return account_name( "holder.", i % HOLDERS ); }
+
+   // system state of `eosio` (see external/eosio.system `init`), WRAM token & funded accounts
+   void setup() {
+      auto& s = native::state();
+      s = native::chain_state{};
+      for ( const auto account : { SYSTEM, CONTRACT, "eosio.ram"_n, "eosio.token"_n, "alice"_n, "bob"_n, "charles"_n } ) {
+         s.accounts.insert( account );
+      }
+      for ( uint32_t i = 0; i < 10; ++i ) s.accounts.insert( account_name( "user.", i ) );
+      for ( uint32_t i = 0; i < HOLDERS; ++i ) s.accounts.insert( holder( i ) );
+
+      eosiosystem::system_contract::rammarket rammarket( SYSTEM, SYSTEM.value );
+      rammarket.emplace( SYSTEM, [&]( auto& m ) {
+         m.supply = asset( 100000000000000, eosiosystem::system_contract::ramcore_symbol );
+         m.base.balance = asset( 129542469746, symbol("RAM", 0) );
+         m.quote.balance = asset( 147223045946, EOS );
+      });
+
+      eosiosystem::system_contract::eosio_global_state global{};
+      global.max_ram_size = MAX_RAM_SIZE;
+      global.total_ram_bytes_reserved = TOTAL_RAM_BYTES_RESERVED;
+      set_system_global( global );
+
+      // holders in the compact row format, as once `compact_balances` is enabled & balances migrated
+      apply( CONTRACT, []( wram& c ) { c.setconfig( false, true ); });
+      apply( CONTRACT, []( wram& c ) { c.create( CONTRACT, asset( MAX_RAM_SIZE, WRAM ) ); });
+
+      wrap( "alice"_n, 1000000000 );
+      wrap( "bob"_n, 1000000000 );
+      for ( uint32_t i = 0; i < HOLDERS; ++i ) wrap( holder( i ), 1000000 );
+   }
+
+   void add_egress_accounts() {
+      std::set<name> accounts;
+      for ( uint32_t i = 0; i < EGRESS_ACCOUNTS; ++i ) accounts.insert( account_name( "egress.", i ) );
+      apply( CONTRACT, [&]( wram& c ) { c.addegress( accounts ); });
+   }
+
+   template<typename Op>
+   result run( const std::string& label, uint64_t iterations, Op&& op ) {
+      auto& stats = native::state().stats;
+
+      // deterministic counters, also warms up the host
+      stats = native::counters{};
+      for ( uint64_t i = 0; i < PROBE_OPS; ++i ) op( i );
+      const native::counters probe = stats;
+
+      const auto start = std::chrono::steady_clock::now();
+      for ( uint64_t i = PROBE_OPS; i < PROBE_OPS + iterations; ++i ) op( i );
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+
+      const double n = static_cast<double>( PROBE_OPS );
+      return {
+         label,
+         iterations,
+         std::chrono::duration<double, std::nano>( elapsed ).count() / static_cast<double>( iterations ),
+         probe.db_reads / n,
+         probe.db_writes / n,
+         probe.inline_actions / n,
+         probe.ram_bytes / n,
+      };
+   }
+
+   // baseline file, one JSON object per benchmark
+   void write_baseline( const std::string& path, const std::vector<result>& results ) {
+      FILE* file = std::fopen( path.c_str(), "w" );
+      if ( !file ) {
+         std::fprintf( stderr, "cannot write baseline %s\n", path.c_str() );
+         std::exit( 2 );
+      }
+      std::fprintf( file, "{\n" );
+      for ( size_t i = 0; i < results.size(); ++i ) {
+         const auto& r = results[i];
+         std::fprintf( file, "   \"%s\": { \"db_reads\": %.2f, \"db_writes\": %.2f, \"inline_actions\": %.2f, \"ram_bytes\": %.2f, \"ns_per_op\": %.1f }%s\n",
+                       r.name.c_str(), r.db_reads, r.db_writes, r.inline_actions, r.ram_bytes, r.ns_per_op, i + 1 < results.size() ? "," : "" );
+      }
+      std::fprintf( file, "}\n" );
+      std::fclose( file );
+   }
+
+   std::map<std::string, std::map<std::string, double>> read_baseline( const std::string& path ) {
+      std::ifstream file( path );
+      if ( !file ) {
+         std::fprintf( stderr, "cannot read baseline %s\n", path.c_str() );
+         std::exit( 2 );
+      }
+      std::map<std::string, std::map<std::string, double>> baseline;
+      const std::regex entry( R"re("([^"]+)"\s*:\s*\{([^}]*)\})re" );
+      const std::regex field( R"re("([^"]+)"\s*:\s*(-?[0-9.]+))re" );
+      const std::string json( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+      for ( std::sregex_iterator e( json.begin(), json.end(), entry ), end; e != end; ++e ) {
+         const std::string fields = (*e)[2];
+         for ( std::sregex_iterator f( fields.begin(), fields.end(), field ); f != end; ++f ) {
+            baseline[(*e)[1]][(*f)[1]] = std::stod( (*f)[2] );
+         }
+      }
+      return baseline;
+   }
+
+   // fails when any counter exceeds the baseline, or the time per op exceeds it by more than `time_tolerance` percent
+   bool compare_baseline( const std::map<std::string, std::map<std::string, double>>& baseline, const std::vector<result>& results, double time_tolerance ) {
+      bool ok = true;
+      for ( const auto& r : results ) {
+         const auto itr = baseline.find( r.name );
+         if ( itr == baseline.end() ) {
+            std::fprintf( stderr, "%s: no baseline\n", r.name.c_str() );
+            continue;
+         }
+         const std::vector<std::pair<const char*, double>> counters = {
+            { "db_reads", r.db_reads }, { "db_writes", r.db_writes }, { "inline_actions", r.inline_actions }, { "ram_bytes", r.ram_bytes },
+         };
+         for ( const auto& [key, value] : counters ) {
+            const auto expected = itr->second.find( key );
+            if ( expected == itr->second.end() || value <= expected->second + 0.005 ) continue;
+            std::fprintf( stderr, "%s: %s regressed from %.2f to %.2f\n", r.name.c_str(), key, expected->second, value );
+            ok = false;
+         }
+         const auto ns = itr->second.find( "ns_per_op" );
+         if ( time_tolerance >= 0 && ns != itr->second.end() && r.ns_per_op > ns->second * (1 + time_tolerance / 100) ) {
+            std::fprintf( stderr, "%s: ns/op regressed from %.1f to %.1f\n", r.name.c_str(), ns->second, r.ns_per_op );
+            ok = false;
+         }
+      }
+      return ok;
+   }
+
+   // WRAM supply must mirror the system RAM reserved bytes after every action
+   bool check_supply() {
+      const int64_t supply = wram::get_supply( CONTRACT, WRAM.code() ).amount;
+      const int64_t reserved = static_cast<int64_t>( get_system_global().total_ram_bytes_reserved );
+      if ( supply == reserved ) return true;
+      std::fprintf( stderr, "supply %lld does not match total_ram_bytes_reserved %lld\n", (long long)supply, (long long)reserved );
+      return false;
+   }
+
+} /// namespace
+
+int main( int argc, char** argv ) {
+   uint64_t iterations = 100000;
+   std::string filter;
+   std::string baseline_path;
+   std::string write_baseline_path;
+   double time_tolerance = -1;
+   for ( int i = 1; i < argc; ++i ) {
+      if ( !std::strcmp( argv[i], "--quick" ) ) iterations = 1000;
+      else if ( !std::strcmp( argv[i], "--iterations" ) && i + 1 < argc ) iterations = std::strtoull( argv[++i], nullptr, 10 );
+      else if ( !std::strcmp( argv[i], "--filter" ) && i + 1 < argc ) filter = argv[++i];
+      else if ( !std::strcmp( argv[i], "--baseline" ) && i + 1 < argc ) baseline_path = argv[++i];
+      else if ( !std::strcmp( argv[i], "--write-baseline" ) && i + 1 < argc ) write_baseline_path = argv[++i];
+      else if ( !std::strcmp( argv[i], "--time-tolerance" ) && i + 1 < argc ) time_tolerance = std::strtod( argv[++i], nullptr );
+      else {
+         std::fprintf( stderr, "usage: %s [--quick] [--iterations N] [--filter substring] [--baseline file] [--write-baseline file] [--time-tolerance percent]\n", argv[0] );
+         return 2;
+      }
+   }
+   if ( iterations == 0 ) iterations = 1;
+
+   struct benchmark {
+      std::string name;
+      std::function<void()> prepare;
+      std::function<void(uint64_t)> op;
+   };
+
+   const auto transfer = []( name from, name to, int64_t amount ) {
+      apply( from, [&]( wram& c ) { c.transfer( from, to, asset( amount, WRAM ), "" ); });
+   };
+
+   const auto transfers = []( name from, uint32_t recipients ) {
+      std::vector<wram::transfer_params> params;
+      for ( uint32_t i = 0; i < recipients; ++i ) params.push_back( { account_name( "user.", i ), asset( 1, WRAM ), "" } );
+      apply( from, [&]( wram& c ) { c.transfers( from, params ); });
+   };
+
+   const auto unwrap = []( name owner, int64_t bytes ) {
+      apply( owner, [&]( wram& c ) { c.unwrap( owner, bytes ); });
+   };
+
+   // system `buyrambytes` reserves the bytes before notifying with `logbuyram`
+   const auto buyrambytes = []( name payer, int64_t bytes ) {
+      auto global = get_system_global();
+      global.total_ram_bytes_reserved += bytes;
+      set_system_global( global );
+
+      apply( SYSTEM, { SYSTEM }, {}, [&]( wram& c ) {
+         c.on_logbuyram( payer, CONTRACT, asset( 0, EOS ), bytes, 0 );
+      });
+   };
+
+   const std::vector<benchmark> benchmarks = {
+      { "transfer", nullptr, [&]( uint64_t i ) {
+         transfer( holder( i ), holder( i + 1 ), 1 );
+      }},
+      { "transfer (new recipient)", nullptr, [&]( uint64_t i ) {
+         const name to = account_name( "new.", i );
+         native::state().accounts.insert( to );
+         transfer( "alice"_n, to, 1 );
+      }},
+      { "transfer (256 egress accounts)", add_egress_accounts, [&]( uint64_t i ) {
+         transfer( holder( i ), holder( i + 1 ), 1 );
+      }},
+      { "transferfrom", []() {
+         apply( "alice"_n, []( wram& c ) { c.approve( "alice"_n, "bob"_n, 1000000000 ); });
+      }, [&]( uint64_t i ) {
+         apply( "bob"_n, [&]( wram& c ) { c.transferfrom( "bob"_n, "alice"_n, holder( i ), asset( 1, WRAM ) ); });
+      }},
+      { "transfers (10 recipients)", nullptr, [&]( uint64_t ) {
+         transfers( "alice"_n, 10 );
+      }},
+      { "unwrap", nullptr, [&]( uint64_t i ) {
+         unwrap( holder( i ), 1 );
+      }},
+      { "wrap (ramtransfer)", nullptr, []( uint64_t i ) {
+         wrap( holder( i ), 1 );
+      }},
+      { "wrap (buyrambytes)", nullptr, [&]( uint64_t i ) {
+         buyrambytes( holder( i ), 100 );
+      }},
+      { "notify (foreign transfer)", nullptr, []( uint64_t ) {
+         apply( "fake.token"_n, { "alice"_n }, pack( std::make_tuple( "alice"_n, "bob"_n, asset( 1, EOS ), std::string() ) ), []( wram& c ) {
+            c.on_transfer();
+         });
+      }},
+      // transfers dominate, followed by wraps & unwraps, deterministic per operation index
+      { "mix (2000 holders, 256 egress)", add_egress_accounts, [&]( uint64_t i ) {
+         const uint64_t r = ( i * 6364136223846793005ULL + 1442695040888963407ULL ) >> 33;
+         const name from = holder( r );
+         const name to = holder( r >> 11 );
+         switch ( r % 20 ) {
+            case 0: case 1: wrap( from, 10 ); break;
+            case 2: buyrambytes( from, 100 ); break;
+            case 3: unwrap( from, 10 ); break;
+            case 4: transfers( from, 3 ); break;
+            default: if ( from != to ) transfer( from, to, 1 ); break;
+         }
+      }},
+   };
+
+   std::printf( "%-34s %12s %12s %10s %10s %10s %10s\n", "benchmark", "iterations", "ns/op", "reads/op", "writes/op", "inline/op", "ram/op" );
+
+   bool ok = true;
+   std::vector<result> results;
+   for ( const auto& b : benchmarks ) {
+      if ( !filter.empty() && b.name.find( filter ) == std::string::npos ) continue;
+
+      setup();
+      if ( b.prepare ) b.prepare();
+
+      try {
+         const auto r = run( b.name, iterations, b.op );
+         std::printf( "%-34s %12llu %12.1f %10.2f %10.2f %10.2f %10.2f\n", r.name.c_str(), (unsigned long long)r.iterations, r.ns_per_op, r.db_reads, r.db_writes, r.inline_actions, r.ram_bytes );
+         results.push_back( r );
+      } catch ( const eosio_assert_error& e ) {
+         std::fprintf( stderr, "%s: %s\n", b.name.c_str(), e.what() );
+         ok = false;
+         continue;
+      }
+      ok = check_supply() && ok;
+
+#ifdef WRAM_METRICS
+      apply( CONTRACT, []( wram& c ) {
+         const auto m = c.getmetrics();
+         std::printf( "%-34s mirror %llu issues (%llu bytes) %llu retires (%llu bytes), egress %llu checks %llu searches, balances %llu emplaces %llu modifies\n", "",
+                      (unsigned long long)m.mirror_issues, (unsigned long long)m.mirror_issued, (unsigned long long)m.mirror_retires, (unsigned long long)m.mirror_retired,
+                      (unsigned long long)m.egress_checks, (unsigned long long)m.egress_searches, (unsigned long long)m.balance_emplaces, (unsigned long long)m.balance_modifies );
+      });
+#endif
+   }
+
+   if ( !write_baseline_path.empty() ) write_baseline( write_baseline_path, results );
+   if ( !baseline_path.empty() ) ok = compare_baseline( read_baseline( baseline_path ), results, time_tolerance ) && ok;
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,469 @@
+/**
+ * Property-based stress harness of the `eosio.wram` mirror invariant.
+ *
+ * Runs long seeded random sequences of system RAM actions (`buyram`, `buyrambytes`, `sellram`,
+ * `ramtransfer`) and WRAM actions (`transfer`, `unwrap`, `unwrapsell`, `open`, `close`, `addegress`,
+ * `removeegress`, `audit`, `setconfig`, `migrate`, `index`, `reap`, `approve`, `transferfrom`) across many accounts. Each step is a transaction: the action, its notifications
+ * & inline actions are executed against the mock system & token contracts (external/) and
+ * rolled back when any of them fails.
+ *
+ * After every committed step:
+ * - the sum of all balances equals the WRAM supply
+ * - every non-zero balance matches its `holders` index row
+ * - the raw reads of the client header (include/eosio.wram) match the contract's own balances & supply
+ * - the WRAM supply equals `total_ram_bytes_reserved` when `eosio.wram` mirrored system RAM
+ *   (wrap & unwrap), system RAM actions without a wrap leave the adjustment pending
+ * - every finished `audit`, walked in small batches between the other actions, is balanced
+ * - the latest `history` record, written once per block, holds the mirrored supply
+ * - `transfer`, `transferfrom` & `unwrap` return the balances & supply after the transaction
+ * - `unwrapsell` forwards all `sellram` proceeds, leaving no core tokens in `eosio.wram`
+ *
+ * Usage: wram_fuzz [--quick] [--steps N] [--seed N] [--accounts N]
+ */
+#include "eosio.wram.cpp"
+#include "external/eosio.system/eosio.cpp"
+#include "external/eosio.token/eosio.token.cpp"
+#include <eosio.wram/eosio.wram.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace eosio;
+
+namespace {
+
+   constexpr name CONTRACT = "eosio.wram"_n;
+   constexpr name SYSTEM = "eosio"_n;
+   constexpr name TOKEN = "eosio.token"_n;
+   constexpr symbol WRAM = symbol( symbol_code("WRAM"), 0 );
+   constexpr symbol EOS = symbol( symbol_code("EOS"), 4 );
+
+   using handler = std::function<void( name receiver, name code )>;
+
+   // action handlers of a contract, unpacking the action data into the handler parameters
+   // & packing any result as the action return value, like the CDT dispatcher
+   template<typename Contract, typename R, typename... Args>
+   handler make_handler( R (Contract::*fn)( Args... ) ) {
+      return [fn]( name receiver, name code ) {
+         auto& s = native::state();
+         auto args = unpack<std::tuple<std::decay_t<Args>...>>( s.action_data );
+         Contract contract( receiver, code, datastream<const char*>( s.action_data.data(), s.action_data.size() ) );
+         if constexpr ( std::is_void_v<R> ) {
+            std::apply( [&]( auto&... a ) { (contract.*fn)( a... ); }, args );
+         } else {
+            auto result = pack( std::apply( [&]( auto&... a ) { return (contract.*fn)( a... ); }, args ) );
+            internal_use_do_not_use::set_action_return_value( result.data(), result.size() );
+         }
+      };
+   }
+
+   /**
+    * Executes transactions like nodeos: the action on its account, then on every notified
+    * account, then the inline actions sent by all of them, depth first.
+    */
+   class executor {
+      public:
+         void add_action( name account, name action, handler h ) { _actions[{account, action}] = std::move(h); }
+         void add_notify( name receiver, name code, name action, handler h ) { _notifies[{receiver, code, action}] = std::move(h); }
+
+         uint64_t actions() const { return _executed; }
+
+         // whether `account::action` was executed by the last committed transaction
+         bool executed( name account, name action ) const {
+            return std::find( _trace.begin(), _trace.end(), std::make_pair( account, action ) ) != _trace.end();
+         }
+
+         // return value of the last committed transaction's action
+         const std::vector<char>& return_value() const { return _return_value; }
+
+         // returns false (with the state rolled back) when any action of the transaction failed
+         bool transact( name account, name action, std::vector<name> auths, std::vector<char> data, std::string* error = nullptr ) {
+            auto& s = native::state();
+            s.begin_transaction();
+            _trace.clear();
+            _return_value.clear();
+            try {
+               native::inline_action act{ account, action, {}, std::move(data) };
+               for ( const auto auth : auths ) act.authorization.emplace_back( auth, "active"_n );
+               execute( act, name() );
+               s.commit_transaction();
+               return true;
+            } catch ( const eosio_assert_error& e ) {
+               s.rollback_transaction();
+               if ( error ) *error = e.what();
+               return false;
+            }
+         }
+
+      private:
+         void execute( const native::inline_action& act, name sender ) {
+            std::vector<std::pair<name, native::inline_action>> inlines;
+            std::vector<name> notified = { act.account };
+
+            for ( size_t i = 0; i < notified.size(); ++i ) {
+               const name receiver = notified[i];
+               const handler* h = find( receiver, act );
+               if ( !h ) continue;
+
+               auto& s = native::state();
+               std::vector<name> auths;
+               for ( const auto& [actor, permission] : act.authorization ) auths.push_back( actor );
+               s.begin_action( receiver, act.account, auths, act.data );
+               s.sender = sender;
+               (*h)( receiver, act.account );
+               _executed++;
+               if ( receiver == act.account ) _trace.emplace_back( act.account, act.action );
+               if ( receiver == act.account && sender == name() ) _return_value = s.return_value;
+
+               for ( const auto recipient : s.recipients ) {
+                  if ( std::find( notified.begin(), notified.end(), recipient ) == notified.end() ) notified.push_back( recipient );
+               }
+               for ( auto& inline_act : s.inline_actions ) inlines.emplace_back( receiver, std::move(inline_act) );
+            }
+
+            for ( const auto& [from, inline_act] : inlines ) execute( inline_act, from );
+         }
+
+         const handler* find( name receiver, const native::inline_action& act ) const {
+            if ( receiver == act.account ) {
+               const auto itr = _actions.find( {act.account, act.action} );
+               return itr == _actions.end() ? nullptr : &itr->second;
+            }
+            auto itr = _notifies.find( {receiver, act.account, act.action} );
+            if ( itr == _notifies.end() ) itr = _notifies.find( {receiver, name(), act.action} ); // `*::action`
+            return itr == _notifies.end() ? nullptr : &itr->second;
+         }
+
+         std::map<std::pair<name, name>, handler>           _actions;
+         std::map<std::tuple<name, name, name>, handler>    _notifies;
+         std::vector<std::pair<name, name>>                 _trace;
+         std::vector<char>                                  _return_value;
+         uint64_t                                           _executed = 0;
+   };
+
+   name account_name( uint32_t i ) {
+      std::string str = "fuzz.";
+      for ( uint32_t div = 26 * 26 * 26; div > 0; div /= 26 ) str += char( 'a' + (i / div) % 26 );
+      return name( str );
+   }
+
+   executor make_executor() {
+      executor chain;
+      chain.add_action( SYSTEM, "buyram"_n, make_handler( &system_contract::buyram ) );
+      chain.add_action( SYSTEM, "buyrambytes"_n, make_handler( &system_contract::buyrambytes ) );
+      chain.add_action( SYSTEM, "sellram"_n, make_handler( &system_contract::sellram ) );
+      chain.add_action( SYSTEM, "ramtransfer"_n, make_handler( &system_contract::ramtransfer ) );
+      chain.add_action( SYSTEM, "logbuyram"_n, make_handler( &system_contract::logbuyram ) );
+      chain.add_action( SYSTEM, "init"_n, make_handler( &system_contract::init ) );
+
+      chain.add_action( TOKEN, "create"_n, make_handler( &token::create ) );
+      chain.add_action( TOKEN, "issue"_n, make_handler( &token::issue ) );
+      chain.add_action( TOKEN, "transfer"_n, make_handler( &token::transfer ) );
+
+      chain.add_action( CONTRACT, "create"_n, make_handler( &wram::create ) );
+      chain.add_action( CONTRACT, "transfer"_n, make_handler( &wram::transfer ) );
+      chain.add_action( CONTRACT, "unwrap"_n, make_handler( &wram::unwrap ) );
+      chain.add_action( CONTRACT, "unwrapsell"_n, make_handler( &wram::unwrapsell ) );
+      chain.add_action( CONTRACT, "settlesell"_n, make_handler( &wram::settlesell ) );
+      chain.add_action( CONTRACT, "open"_n, make_handler( &wram::open ) );
+      chain.add_action( CONTRACT, "close"_n, make_handler( &wram::close ) );
+      chain.add_action( CONTRACT, "addegress"_n, make_handler( &wram::addegress ) );
+      chain.add_action( CONTRACT, "removeegress"_n, make_handler( &wram::removeegress ) );
+      chain.add_action( CONTRACT, "audit"_n, make_handler( &wram::audit ) );
+      chain.add_action( CONTRACT, "setconfig"_n, make_handler( &wram::setconfig ) );
+      chain.add_action( CONTRACT, "migrate"_n, make_handler( &wram::migrate ) );
+      chain.add_action( CONTRACT, "index"_n, make_handler( &wram::index ) );
+      chain.add_action( CONTRACT, "reap"_n, make_handler( &wram::reap ) );
+      chain.add_action( CONTRACT, "approve"_n, make_handler( &wram::approve ) );
+      chain.add_action( CONTRACT, "transferfrom"_n, make_handler( &wram::transferfrom ) );
+      chain.add_action( CONTRACT, "logwrap"_n, make_handler( &wram::logwrap ) );
+      chain.add_action( CONTRACT, "logunwrap"_n, make_handler( &wram::logunwrap ) );
+      chain.add_action( CONTRACT, "logmirror"_n, make_handler( &wram::logmirror ) );
+
+      chain.add_notify( CONTRACT, SYSTEM, "ramtransfer"_n, make_handler( &wram::on_ramtransfer ) );
+      chain.add_notify( CONTRACT, SYSTEM, "logbuyram"_n, make_handler( &wram::on_logbuyram ) );
+      chain.add_notify( CONTRACT, name(), "transfer"_n, make_handler( &wram::on_transfer ) );
+      return chain;
+   }
+
+   int64_t system_reserved() {
+      eosiosystem::system_contract::global_state_singleton global( SYSTEM, SYSTEM.value );
+      return global.get().total_ram_bytes_reserved;
+   }
+
+   int64_t ram_bytes( name owner ) {
+      eosiosystem::system_contract::user_resources_table userres( SYSTEM, owner.value );
+      const auto itr = userres.find( owner.value );
+      return itr == userres.end() ? 0 : itr->ram_bytes;
+   }
+
+   // sum of all compact & legacy balance rows, every balance must match its holder row
+   // `eosio.token` balance of `owner` in the core token
+   int64_t core_balance( name owner ) {
+      const auto& db = native::state().db;
+      const auto rows = db.find( {TOKEN.value, owner.value, "accounts"_n.value} );
+      if ( rows == db.end() || rows->second.count( EOS.code().raw() ) == 0 ) return 0;
+      return unpack<asset>( rows->second.at( EOS.code().raw() ).data ).amount;
+   }
+
+   // `unindexed` owners held a balance since before the `holders` index (until credited, debited or `index`ed)
+   bool check_balances( int64_t supply, const std::set<uint64_t>& unindexed, std::string& error ) {
+      auto& db = native::state().db;
+      int64_t total = 0;
+      std::map<uint64_t, int64_t> balances;
+      for ( const auto& [id, rows] : db ) {
+         const auto& [code, scope, table] = id;
+         if ( code != CONTRACT.value || rows.empty() ) continue;
+         if ( table == "balances"_n.value ) {
+            const auto amount = unpack<int64_t>( rows.begin()->second.data );
+            balances[scope] += amount;
+            total += amount;
+         } else if ( table == "accounts"_n.value ) {
+            const auto amount = unpack<asset>( rows.begin()->second.data ).amount;
+            balances[scope] += amount;
+            total += amount;
+         }
+      }
+      if ( total != supply ) {
+         error = "sum of balances " + std::to_string(total) + " does not match supply " + std::to_string(supply);
+         return false;
+      }
+
+      if ( eosiowram::get_supply( CONTRACT ) != supply ) {
+         error = "client supply does not match supply " + std::to_string(supply);
+         return false;
+      }
+
+      wram::holders holders( CONTRACT, CONTRACT.value );
+      for ( const auto& [owner, balance] : balances ) {
+         // rows created by `open` are not indexed until credited
+         const auto itr = holders.find( owner );
+         if ( itr == holders.end() ? balance != 0 && !unindexed.count( owner ) : itr->balance != balance ) {
+            error = "holder " + name(owner).to_string() + " does not match balance " + std::to_string(balance);
+            return false;
+         }
+         if ( eosiowram::get_balance( name(owner), CONTRACT ) != balance ) {
+            error = "client balance of " + name(owner).to_string() + " does not match balance " + std::to_string(balance);
+            return false;
+         }
+      }
+      return true;
+   }
+
+} /// namespace
+
+int main( int argc, char** argv ) {
+   uint64_t steps = 100000;
+   uint64_t seed = 1;
+   uint32_t num_accounts = 200;
+   for ( int i = 1; i < argc; ++i ) {
+      if ( !std::strcmp( argv[i], "--quick" ) ) steps = 5000;
+      else if ( !std::strcmp( argv[i], "--steps" ) && i + 1 < argc ) steps = std::strtoull( argv[++i], nullptr, 10 );
+      else if ( !std::strcmp( argv[i], "--seed" ) && i + 1 < argc ) seed = std::strtoull( argv[++i], nullptr, 10 );
+      else if ( !std::strcmp( argv[i], "--accounts" ) && i + 1 < argc ) num_accounts = std::max( 2ul, std::strtoul( argv[++i], nullptr, 10 ) );
+      else {
+         std::fprintf( stderr, "usage: %s [--quick] [--steps N] [--seed N] [--accounts N]\n", argv[0] );
+         return 2;
+      }
+   }
+
+   auto& s = native::state();
+   for ( const auto account : { SYSTEM, CONTRACT, "eosio.ram"_n, "eosio.token"_n } ) s.accounts.insert( account );
+   std::vector<name> accounts;
+   for ( uint32_t i = 0; i < num_accounts; ++i ) {
+      accounts.push_back( account_name( i ) );
+      s.accounts.insert( accounts.back() );
+   }
+
+   executor chain = make_executor();
+   std::string error;
+   if ( !chain.transact( SYSTEM, "init"_n, { SYSTEM }, {}, &error ) ||
+        !chain.transact( CONTRACT, "create"_n, { CONTRACT }, pack( std::make_tuple( CONTRACT, asset( 418945440768, WRAM ) ) ), &error ) ||
+        !chain.transact( TOKEN, "create"_n, { TOKEN }, pack( std::make_tuple( TOKEN, asset( 10000000000000, EOS ) ) ), &error ) ||
+        !chain.transact( TOKEN, "issue"_n, { TOKEN }, pack( std::make_tuple( TOKEN, asset( 10000000000000, EOS ), std::string() ) ), &error ) ||
+        !chain.transact( TOKEN, "transfer"_n, { TOKEN }, pack( std::make_tuple( TOKEN, "eosio.ram"_n, asset( 10000000000000, EOS ), std::string() ) ), &error ) ) {
+      std::fprintf( stderr, "setup failed: %s\n", error.c_str() );
+      return 1;
+   }
+
+   // balances held since before the `holders` index, as on an upgraded chain (see `index`)
+   std::set<uint64_t> unindexed;
+   for ( uint32_t i = 0; i < num_accounts / 20; ++i ) {
+      const name owner = accounts[i];
+      if ( !chain.transact( CONTRACT, "transfer"_n, { CONTRACT }, pack( std::make_tuple( CONTRACT, owner, asset( 100000, WRAM ), std::string() ) ), &error ) ) {
+         std::fprintf( stderr, "setup failed: %s\n", error.c_str() );
+         return 1;
+      }
+      wram::holders holders( CONTRACT, CONTRACT.value );
+      holders.erase( holders.find( owner.value ) );
+      unindexed.insert( owner.value );
+   }
+
+   std::mt19937_64 rng( seed );
+   const auto pick = [&]() { return accounts[rng() % accounts.size()]; };
+   const auto amount = [&]( int64_t max ) { return int64_t( rng() % uint64_t(max) ) + 1; };
+   const auto wram_balance = []( name owner ) {
+      const auto balance = wram::find_balance( CONTRACT, owner, WRAM.code() );
+      return balance ? balance->amount : 0;
+   };
+
+   std::map<std::string, uint64_t> rejected;
+   uint64_t committed = 0;
+   uint64_t audits = 0;
+   uint64_t unbalanced = 0;
+   uint64_t sales = 0;
+   const auto start = std::chrono::steady_clock::now();
+
+   for ( uint64_t step = 0; step < steps; ++step ) {
+      const name a = pick();
+      const name b = pick();
+      const uint64_t op = rng() % 24;
+
+      // several transactions per block, wrapping around the `history` ring buffer
+      if ( rng() % 2 ) s.block_time.slot++;
+
+      // mostly valid amounts, with some overdrawn ones to exercise the rollback paths
+      const int64_t held = wram_balance( a );
+      const int64_t bytes = held > 0 && rng() % 8 ? amount( held ) : amount( 100000 );
+      const int64_t ram = ram_bytes( a );
+      const int64_t ram_amount = ram > 0 && rng() % 8 ? amount( ram ) : amount( 100000 );
+      // wrap memos: credit the sender, a beneficiary (sometimes invalid) or nobody
+      const auto ram_memo = [&]( name beneficiary ) {
+         switch ( rng() % 8 ) {
+            case 0: return std::string( "ignore" );
+            case 1: case 2: return "to:" + beneficiary.to_string();
+            case 3: return std::string( rng() % 2 ? "to:" : "to:fuzz.Bad" );
+            default: return std::string();
+         }
+      };
+
+      const int64_t core = core_balance( a );
+      bool ok = false;
+      name to; // receiver of transfers & unwraps, returning their post-state
+      switch ( op ) {
+         case 0: case 1: ok = chain.transact( SYSTEM, "buyram"_n, { a }, pack( std::make_tuple( a, rng() % 2 ? CONTRACT : a, asset( amount( 100000 ), EOS ) ) ), &error ); break;
+         case 2: ok = chain.transact( SYSTEM, "buyrambytes"_n, { a }, pack( std::make_tuple( a, rng() % 2 ? CONTRACT : a, uint32_t( amount( 100000 ) ) ) ), &error ); break;
+         case 3: ok = chain.transact( SYSTEM, "sellram"_n, { a }, pack( std::make_tuple( a, ram_amount ) ), &error ); break;
+         case 4: case 5: ok = chain.transact( SYSTEM, "ramtransfer"_n, { a }, pack( std::make_tuple( a, rng() % 4 ? CONTRACT : b, ram_amount, ram_memo( b ) ) ), &error ); break;
+         case 6: case 7: case 8: case 9: to = b; ok = chain.transact( CONTRACT, "transfer"_n, { a }, pack( std::make_tuple( a, b, asset( bytes, WRAM ), std::string() ) ), &error ); break;
+         case 10: to = CONTRACT; ok = chain.transact( CONTRACT, "transfer"_n, { a }, pack( std::make_tuple( a, CONTRACT, asset( bytes, WRAM ), std::string() ) ), &error ); break;
+         case 11: to = CONTRACT; ok = chain.transact( CONTRACT, "unwrap"_n, { a }, pack( std::make_tuple( a, bytes ) ), &error ); break;
+         case 12: ok = chain.transact( CONTRACT, "open"_n, { b }, pack( std::make_tuple( a, WRAM, b ) ), &error ); break;
+         case 13: ok = chain.transact( CONTRACT, "close"_n, { a }, pack( std::make_tuple( a, WRAM ) ), &error ); break;
+         // egress additions are rarer than removals to keep most accounts able to receive
+         case 14: if ( rng() % 4 ) { ok = chain.transact( CONTRACT, "removeegress"_n, { CONTRACT }, pack( std::set<name>{ a } ), &error ); break; }
+                  ok = chain.transact( CONTRACT, "addegress"_n, { CONTRACT }, pack( std::set<name>{ a } ), &error ); break;
+         case 15: ok = chain.transact( CONTRACT, "removeegress"_n, { CONTRACT }, pack( std::set<name>{ a } ), &error ); break;
+         case 16: {
+            // mostly continue the audit in progress, sometimes restart it (only stale audits or by the contract)
+            wram::auditstate state( CONTRACT, CONTRACT.value );
+            const name cursor = state.exists() && rng() % 8 ? state.get().next : name();
+            const name auditor = rng() % 16 ? a : CONTRACT;
+            ok = chain.transact( CONTRACT, "audit"_n, { auditor }, pack( std::make_tuple( cursor, uint32_t( amount( 50 ) ) ) ), &error );
+            break;
+         }
+         case 17: ok = chain.transact( CONTRACT, "setconfig"_n, { CONTRACT }, pack( std::make_tuple( bool( rng() % 2 ), bool( rng() % 2 ) ) ), &error ); break;
+         case 18: ok = chain.transact( CONTRACT, "reap"_n, { a }, pack( std::make_tuple( uint32_t( amount( 20 ) ), rng() % 2 ? std::vector<name>{ a, b } : std::vector<name>{} ) ), &error ); break;
+         case 19: ok = chain.transact( CONTRACT, "approve"_n, { a }, pack( std::make_tuple( a, b, rng() % 4 ? bytes : int64_t( 0 ) ) ), &error ); break;
+         case 20: {
+            // spend an existing allowance of `a` when there is one
+            wram::allowances allowances( CONTRACT, a.value );
+            const name spender = allowances.begin() != allowances.end() && rng() % 4 ? allowances.begin()->spender : b;
+            to = rng() % 4 ? pick() : CONTRACT;
+            ok = chain.transact( CONTRACT, "transferfrom"_n, { spender }, pack( std::make_tuple( spender, a, to, asset( bytes, WRAM ) ) ), &error );
+            break;
+         }
+         // mostly without a slippage bound, some above any possible proceeds
+         case 21: ok = chain.transact( CONTRACT, "unwrapsell"_n, { a }, pack( std::make_tuple( a, bytes, asset( rng() % 4 ? 0 : 100000000000, EOS ) ) ), &error ); break;
+         // owners migrate themselves at their expense, the contract any owner at its own
+         case 22: if ( rng() % 8 == 0 ) { ok = chain.transact( CONTRACT, "migrate"_n, { CONTRACT }, pack( std::vector<name>{ a, b } ), &error ); break; }
+                  ok = chain.transact( CONTRACT, "migrate"_n, { a }, pack( std::vector<name>{ a } ), &error ); break;
+         case 23: ok = chain.transact( CONTRACT, "index"_n, { a }, pack( std::make_tuple( a, std::vector<name>{ a, b } ) ), &error ); break;
+      }
+
+      if ( !ok ) {
+         rejected[error]++;
+         continue;
+      }
+      committed++;
+
+      const int64_t supply = wram::get_supply( CONTRACT, WRAM.code() ).amount;
+      std::string violation;
+      if ( !check_balances( supply, unindexed, violation ) ) {
+         std::fprintf( stderr, "invariant violated at step %llu (seed %llu, op %llu): %s\n", (unsigned long long)step, (unsigned long long)seed, (unsigned long long)op, violation.c_str() );
+         return 1;
+      }
+
+      if ( to != name() ) {
+         const auto result = unpack<wram::transfer_result>( chain.return_value() );
+         if ( result.from_balance != wram_balance( a ) || result.to_balance != wram_balance( to ) || result.supply != supply || result.bytes != bytes ) {
+            std::fprintf( stderr, "return value violated at step %llu (seed %llu, op %llu): balances %lld & %lld, supply %lld, bytes %lld\n", (unsigned long long)step, (unsigned long long)seed, (unsigned long long)op,
+                          (long long)result.from_balance, (long long)result.to_balance, (long long)result.supply, (long long)result.bytes );
+            return 1;
+         }
+      }
+
+      if ( chain.executed( CONTRACT, "settlesell"_n ) ) {
+         if ( core_balance( CONTRACT ) != 0 || core_balance( a ) < core ) {
+            std::fprintf( stderr, "unwrapsell violated at step %llu (seed %llu): %lld core tokens left in %s, %s paid %lld\n", (unsigned long long)step, (unsigned long long)seed,
+                          (long long)core_balance( CONTRACT ), CONTRACT.to_string().c_str(), a.to_string().c_str(), (long long)(core_balance( a ) - core) );
+            return 1;
+         }
+         if ( core_balance( a ) > core ) sales++;
+      }
+
+      if ( chain.executed( CONTRACT, "audit"_n ) ) {
+         wram::auditstate state( CONTRACT, CONTRACT.value );
+         wram::auditresult result( CONTRACT, CONTRACT.value );
+         // a finished audit balances exactly when no balance held since before the index is left to `index`
+         wram::holders holders( CONTRACT, CONTRACT.value );
+         bool pending = false;
+         for ( const uint64_t owner : unindexed ) {
+            if ( holders.find( owner ) == holders.end() && wram_balance( name(owner) ) != 0 ) pending = true;
+         }
+         if ( !state.exists() && result.get().balanced == pending ) {
+            const auto r = result.get();
+            std::fprintf( stderr, "audit %s at step %llu (seed %llu): balances %lld, supply %lld, reserved %lld, %u mismatches\n", pending ? "balanced with unindexed holders" : "not balanced",
+                          (unsigned long long)step, (unsigned long long)seed, (long long)r.balances, (long long)r.supply, (long long)r.total_ram_bytes_reserved, r.mismatches );
+            return 1;
+         }
+         if ( !state.exists() ) audits++;
+         if ( !state.exists() && pending ) unbalanced++;
+      }
+
+      // only `eosio.wram` mirroring restores the supply, system RAM actions without a wrap leave it pending
+      if ( chain.executed( CONTRACT, "logwrap"_n ) || chain.executed( CONTRACT, "logunwrap"_n ) || chain.executed( CONTRACT, "logmirror"_n ) ) {
+         const int64_t reserved = system_reserved();
+         if ( supply != reserved ) {
+            std::fprintf( stderr, "invariant violated at step %llu (seed %llu, op %llu): supply %lld does not match total_ram_bytes_reserved %lld\n",
+                          (unsigned long long)step, (unsigned long long)seed, (unsigned long long)op, (long long)supply, (long long)reserved );
+            return 1;
+         }
+
+         wram::historystate state( CONTRACT, CONTRACT.value );
+         wram::history history( CONTRACT, CONTRACT.value );
+         const auto& last = history.get( ( state.get().next - 1 ) % 1024, "history record does not exist" );
+         if ( last.time != s.block_time || last.supply != supply ) {
+            std::fprintf( stderr, "history violated at step %llu (seed %llu, op %llu): record %llu supply %lld does not match supply %lld\n",
+                          (unsigned long long)step, (unsigned long long)seed, (unsigned long long)op, (unsigned long long)last.seq, (long long)last.supply, (long long)supply );
+            return 1;
+         }
+      }
+   }
+
+   const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+   std::printf( "%llu steps (seed %llu, %u accounts): %llu committed, %llu rejected, %llu audits (%llu unbalanced before backfill), %llu paid sales\n", (unsigned long long)steps, (unsigned long long)seed, num_accounts,
+                (unsigned long long)committed, (unsigned long long)(steps - committed), (unsigned long long)audits, (unsigned long long)unbalanced, (unsigned long long)sales );
+   std::printf( "%.0f transactions/s, %.0f actions/s (%llu actions incl. notifications & inline actions)\n", steps / seconds, chain.actions() / seconds, (unsigned long long)chain.actions() );
+   for ( const auto& [reason, count] : rejected ) std::printf( "   %8llu  %s\n", (unsigned long long)count, reason.c_str() );
+   return 0;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/host.hpp>
+#include <eosio/name.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   /**
+    * Native stand-in of `eosio::permission_level`.
+    */
+   struct permission_level {
+      permission_level( name a, name p ) : actor(a), permission(p) {}
+      permission_level() {}
+
+      name actor;
+      name permission;
+   };
+
+   /**
+    * Native stand-in of `eosio::action`, `send()` captures the packed action in the chain state.
+    */
+   struct action {
+      eosio::name                   account;
+      eosio::name                   name;
+      std::vector<permission_level> authorization;
+      std::vector<char>             data;
+
+      action() = default;
+
+      template<typename T>
+      action( const std::vector<permission_level>& auth, struct name a, struct name n, T&& value )
+         : account(a), name(n), authorization(auth), data( pack( std::forward<T>(value) ) ) {}
+
+      template<typename T>
+      action( const permission_level& auth, struct name a, struct name n, T&& value )
+         : account(a), name(n), authorization(1, auth), data( pack( std::forward<T>(value) ) ) {}
+
+      void send() const {
+         auto& s = native::state();
+         native::inline_action act{ account, name, {}, data };
+         for ( const auto& p : authorization ) act.authorization.emplace_back( p.actor, p.permission );
+         s.inline_actions.emplace_back( std::move(act) );
+         s.stats.inline_actions++;
+      }
+   };
+
+   namespace native {
+      template<typename T>
+      struct action_args;
+
+      template<typename C, typename R, typename... Args>
+      struct action_args<R (C::*)(Args...)> {
+         using type = std::tuple<std::decay_t<Args>...>;
+      };
+   }
+
+   /**
+    * Native stand-in of `eosio::action_wrapper`, arguments are converted to the action parameter types.
+    */
+   template<eosio::name::raw Name, auto Action>
+   struct action_wrapper {
+      template<typename Code>
+      constexpr action_wrapper( Code&& code, std::vector<permission_level>&& perms )
+         : code_name( std::forward<Code>(code) ), permissions( std::move(perms) ) {}
+
+      template<typename Code>
+      constexpr action_wrapper( Code&& code, const permission_level& perm )
+         : code_name( std::forward<Code>(code) ), permissions( {1, perm} ) {}
+
+      static constexpr eosio::name action_name = eosio::name(Name);
+      eosio::name code_name;
+      std::vector<permission_level> permissions;
+
+      template<typename... Args>
+      action to_action( Args&&... args ) const {
+         using args_t = typename native::action_args<decltype(Action)>::type;
+         return action( permissions, code_name, action_name, args_t{ std::forward<Args>(args)... } );
+      }
+
+      template<typename... Args>
+      void send( Args&&... args ) const {
+         to_action( std::forward<Args>(args)... ).send();
+      }
+   };
+
+   inline uint32_t read_action_data( void* msg, uint32_t len ) {
+      const auto& data = native::state().action_data;
+      const uint32_t size = std::min<uint32_t>( len, data.size() );
+      if ( size ) std::memcpy( msg, data.data(), size );
+      return size;
+   }
+
+   inline uint32_t action_data_size() {
+      return native::state().action_data.size();
+   }
+
+   template<typename T>
+   T unpack_action_data() {
+      return unpack<T>( native::state().action_data );
+   }
+
+   inline void require_auth( name n ) {
+      const auto& auths = native::state().authorizations;
+      check( auths.count(n) > 0, "missing authority of " + n.to_string() );
+   }
+
+   inline bool has_auth( name n ) {
+      return native::state().authorizations.count(n) > 0;
+   }
+
+   inline bool is_account( name n ) {
+      return native::state().accounts.count(n) > 0;
+   }
+
+   inline name get_sender() {
+      return native::state().sender;
+   }
+
+   template<typename... accounts>
+   void require_recipient( name n, accounts... remaining ) {
+      auto& s = native::state();
+      s.recipients.push_back(n);
+      s.stats.notifications++;
+      if constexpr ( sizeof...(remaining) > 0 ) require_recipient( remaining... );
+   }
+
+   namespace internal_use_do_not_use {
+      inline void set_action_return_value( void* return_value, size_t size ) {
+         auto& value = native::state().return_value;
+         value.assign( static_cast<const char*>(return_value), static_cast<const char*>(return_value) + size );
+      }
+   }
+
+} /// namespace eosio
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/symbol.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace eosio {
+
+   /**
+    * Native stand-in of `eosio::asset`, with the same range & symbol checks as CDT.
+    */
+   struct asset {
+      int64_t        amount = 0;
+      eosio::symbol  symbol;
+
+      static constexpr int64_t max_amount = (1LL << 62) - 1;
+
+      asset() {}
+
+      asset( int64_t a, eosio::symbol s ) : amount(a), symbol{s} {
+         eosio::check( is_amount_within_range(), "magnitude of asset amount must be less than 2^62" );
+         eosio::check( symbol.is_valid(), "invalid symbol name" );
+      }
+
+      bool is_amount_within_range() const { return -max_amount <= amount && amount <= max_amount; }
+      bool is_valid() const { return is_amount_within_range() && symbol.is_valid(); }
+
+      asset operator-() const {
+         asset r = *this;
+         r.amount = -r.amount;
+         return r;
+      }
+
+      asset& operator-=( const asset& a ) {
+         eosio::check( a.symbol == symbol, "attempt to subtract asset with different symbol" );
+         amount -= a.amount;
+         eosio::check( -max_amount <= amount, "subtraction underflow" );
+         eosio::check( amount <= max_amount, "subtraction overflow" );
+         return *this;
+      }
+
+      asset& operator+=( const asset& a ) {
+         eosio::check( a.symbol == symbol, "attempt to add asset with different symbol" );
+         amount += a.amount;
+         eosio::check( -max_amount <= amount, "addition underflow" );
+         eosio::check( amount <= max_amount, "addition overflow" );
+         return *this;
+      }
+
+      friend asset operator+( const asset& a, const asset& b ) {
+         asset result = a;
+         result += b;
+         return result;
+      }
+
+      friend asset operator-( const asset& a, const asset& b ) {
+         asset result = a;
+         result -= b;
+         return result;
+      }
+
+      friend bool operator==( const asset& a, const asset& b ) {
+         eosio::check( a.symbol == b.symbol, "comparison of assets with different symbols is not allowed" );
+         return a.amount == b.amount;
+      }
+
+      friend bool operator!=( const asset& a, const asset& b ) { return !( a == b ); }
+
+      friend bool operator<( const asset& a, const asset& b ) {
+         eosio::check( a.symbol == b.symbol, "comparison of assets with different symbols is not allowed" );
+         return a.amount < b.amount;
+      }
+
+      friend bool operator<=( const asset& a, const asset& b ) { return !( b < a ); }
+      friend bool operator>( const asset& a, const asset& b ) { return b < a; }
+      friend bool operator>=( const asset& a, const asset& b ) { return !( a < b ); }
+
+      std::string to_string() const {
+         const auto precision = symbol.precision();
+         std::string result = std::to_string( amount < 0 ? -amount : amount );
+         if ( precision > 0 ) {
+            if ( result.size() <= precision ) result.insert( 0, precision - result.size() + 1, '0' );
+            result.insert( result.size() - precision, "." );
+         }
+         return ( amount < 0 ? "-" : "" ) + result + " " + symbol.code().to_string();
+      }
+   };
+
+} /// namespace eosio
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace eosio {
+
+   /**
+    * Native stand-in of `eosio_assert`, a failed check aborts the action by throwing.
+    */
+   struct eosio_assert_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   inline void check( bool pred, const char* msg ) {
+      if ( !pred ) throw eosio_assert_error( std::string("eosio_assert: ") + msg );
+   }
+
+   inline void check( bool pred, const std::string& msg ) {
+      if ( !pred ) throw eosio_assert_error( "eosio_assert: " + msg );
+   }
+
+   inline void check( bool pred, const char* msg, size_t n ) {
+      if ( !pred ) throw eosio_assert_error( "eosio_assert: " + std::string(msg, n) );
+   }
+
+   inline void check( bool pred, uint64_t code ) {
+      if ( !pred ) throw eosio_assert_error( "eosio_assert_code: " + std::to_string(code) );
+   }
+
+} /// namespace eosio
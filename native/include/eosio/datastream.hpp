@@ -0,0 +1,281 @@
+#pragma once
+
+#include <eosio/asset.hpp>
+#include <eosio/check.hpp>
+#include <eosio/name.hpp>
+#include <eosio/reflect.hpp>
+#include <eosio/symbol.hpp>
+#include <eosio/time.hpp>
+
+#include <cstring>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   /**
+    * Native stand-in of `eosio::datastream`, read/write/size streams over the CDT binary format.
+    */
+   template<typename T>
+   class datastream;
+
+   template<>
+   class datastream<const char*> {
+      public:
+         datastream( const char* start, size_t s ) : _start(start), _pos(start), _end(start + s) {}
+
+         void read( void* d, size_t s ) {
+            eosio::check( size_t(_end - _pos) >= s, "datastream attempted to read past the end" );
+            std::memcpy( d, _pos, s );
+            _pos += s;
+         }
+
+         void skip( size_t s ) { _pos += s; }
+         const char* pos() const { return _pos; }
+         size_t tellp() const { return size_t(_pos - _start); }
+         size_t remaining() const { return size_t(_end - _pos); }
+
+      private:
+         const char* _start;
+         const char* _pos;
+         const char* _end;
+   };
+
+   template<>
+   class datastream<char*> {
+      public:
+         datastream( char* start, size_t s ) : _start(start), _pos(start), _end(start + s) {}
+
+         void write( const void* d, size_t s ) {
+            eosio::check( size_t(_end - _pos) >= s, "datastream attempted to write past the end" );
+            std::memcpy( _pos, d, s );
+            _pos += s;
+         }
+
+         size_t tellp() const { return size_t(_pos - _start); }
+         size_t remaining() const { return size_t(_end - _pos); }
+
+      private:
+         char* _start;
+         char* _pos;
+         char* _end;
+   };
+
+   template<>
+   class datastream<size_t> {
+      public:
+         explicit datastream( size_t init = 0 ) : _size(init) {}
+
+         void write( const void*, size_t s ) { _size += s; }
+         size_t tellp() const { return _size; }
+
+      private:
+         size_t _size;
+   };
+
+   template<typename Stream> concept read_stream = std::is_same_v<Stream, datastream<const char*>>;
+   template<typename Stream> concept write_stream = std::is_same_v<Stream, datastream<char*>> || std::is_same_v<Stream, datastream<size_t>>;
+
+   // varuint32 length prefix
+   template<write_stream Stream>
+   void pack_varuint32( Stream& ds, uint64_t v ) {
+      do {
+         uint8_t b = uint8_t(v) & 0x7f;
+         v >>= 7;
+         b |= ((v > 0) << 7);
+         ds.write( &b, 1 );
+      } while ( v );
+   }
+
+   template<read_stream Stream>
+   uint32_t unpack_varuint32( Stream& ds ) {
+      uint64_t v = 0;
+      uint8_t b = 0;
+      uint8_t by = 0;
+      do {
+         ds.read( &b, 1 );
+         v |= uint32_t(uint8_t(b) & 0x7f) << by;
+         by += 7;
+      } while ( uint8_t(b) & 0x80 && by < 32 );
+      return static_cast<uint32_t>( v );
+   }
+
+   // arithmetic types
+   template<write_stream Stream, typename T> requires std::is_arithmetic_v<T>
+   Stream& operator<<( Stream& ds, const T& v ) {
+      ds.write( &v, sizeof(T) );
+      return ds;
+   }
+
+   template<read_stream Stream, typename T> requires std::is_arithmetic_v<T>
+   Stream& operator>>( Stream& ds, T& v ) {
+      ds.read( &v, sizeof(T) );
+      return ds;
+   }
+
+   // name, symbol & asset
+   template<write_stream Stream> Stream& operator<<( Stream& ds, const name& v ) { return ds << v.value; }
+   template<read_stream Stream> Stream& operator>>( Stream& ds, name& v ) { return ds >> v.value; }
+
+   template<write_stream Stream> Stream& operator<<( Stream& ds, const symbol_code& v ) { return ds << v.raw(); }
+   template<read_stream Stream> Stream& operator>>( Stream& ds, symbol_code& v ) {
+      uint64_t raw;
+      ds >> raw;
+      v = symbol_code( raw );
+      return ds;
+   }
+
+   template<write_stream Stream> Stream& operator<<( Stream& ds, const symbol& v ) { return ds << v.raw(); }
+   template<read_stream Stream> Stream& operator>>( Stream& ds, symbol& v ) {
+      uint64_t raw;
+      ds >> raw;
+      v = symbol( raw );
+      return ds;
+   }
+
+   template<write_stream Stream> Stream& operator<<( Stream& ds, const asset& v ) { return ds << v.amount << v.symbol; }
+   template<read_stream Stream> Stream& operator>>( Stream& ds, asset& v ) { return ds >> v.amount >> v.symbol; }
+
+   // time types
+   template<write_stream Stream> Stream& operator<<( Stream& ds, const time_point& v ) { return ds << v.elapsed.count(); }
+   template<read_stream Stream> Stream& operator>>( Stream& ds, time_point& v ) {
+      int64_t count;
+      ds >> count;
+      v = time_point( microseconds(count) );
+      return ds;
+   }
+
+   template<write_stream Stream> Stream& operator<<( Stream& ds, const block_timestamp& v ) { return ds << v.slot; }
+   template<read_stream Stream> Stream& operator>>( Stream& ds, block_timestamp& v ) { return ds >> v.slot; }
+
+   // containers
+   template<write_stream Stream>
+   Stream& operator<<( Stream& ds, const std::string& v ) {
+      pack_varuint32( ds, v.size() );
+      if ( v.size() ) ds.write( v.data(), v.size() );
+      return ds;
+   }
+
+   template<read_stream Stream>
+   Stream& operator>>( Stream& ds, std::string& v ) {
+      v.resize( unpack_varuint32( ds ) );
+      if ( v.size() ) ds.read( v.data(), v.size() );
+      return ds;
+   }
+
+   template<write_stream Stream, typename T>
+   Stream& operator<<( Stream& ds, const std::vector<T>& v ) {
+      pack_varuint32( ds, v.size() );
+      for ( const auto& i : v ) ds << i;
+      return ds;
+   }
+
+   template<read_stream Stream, typename T>
+   Stream& operator>>( Stream& ds, std::vector<T>& v ) {
+      v.resize( unpack_varuint32( ds ) );
+      for ( auto& i : v ) ds >> i;
+      return ds;
+   }
+
+   template<write_stream Stream, typename T>
+   Stream& operator<<( Stream& ds, const std::set<T>& v ) {
+      pack_varuint32( ds, v.size() );
+      for ( const auto& i : v ) ds << i;
+      return ds;
+   }
+
+   template<read_stream Stream, typename T>
+   Stream& operator>>( Stream& ds, std::set<T>& v ) {
+      v.clear();
+      const auto size = unpack_varuint32( ds );
+      for ( uint32_t i = 0; i < size; ++i ) {
+         T item;
+         ds >> item;
+         v.emplace( std::move(item) );
+      }
+      return ds;
+   }
+
+   template<write_stream Stream, typename T>
+   Stream& operator<<( Stream& ds, const std::optional<T>& v ) {
+      ds << bool( v.has_value() );
+      if ( v ) ds << *v;
+      return ds;
+   }
+
+   template<read_stream Stream, typename T>
+   Stream& operator>>( Stream& ds, std::optional<T>& v ) {
+      bool valid;
+      ds >> valid;
+      if ( valid ) {
+         T item;
+         ds >> item;
+         v = std::move(item);
+      } else {
+         v.reset();
+      }
+      return ds;
+   }
+
+   template<write_stream Stream, typename... Args>
+   Stream& operator<<( Stream& ds, const std::tuple<Args...>& v ) {
+      std::apply( [&]( const auto&... items ) { ( ( ds << items ), ... ); }, v );
+      return ds;
+   }
+
+   template<read_stream Stream, typename... Args>
+   Stream& operator>>( Stream& ds, std::tuple<Args...>& v ) {
+      std::apply( [&]( auto&... items ) { ( ( ds >> items ), ... ); }, v );
+      return ds;
+   }
+
+   // aggregate table & action structs
+   template<typename T>
+   concept reflected_struct = std::is_class_v<T> && std::is_aggregate_v<T>;
+
+   template<write_stream Stream, reflected_struct T>
+   Stream& operator<<( Stream& ds, const T& v ) {
+      reflect::for_each_field( v, [&]( const auto& field ) { ds << field; } );
+      return ds;
+   }
+
+   template<read_stream Stream, reflected_struct T>
+   Stream& operator>>( Stream& ds, T& v ) {
+      reflect::for_each_field( v, [&]( auto& field ) { ds >> field; } );
+      return ds;
+   }
+
+   template<typename T>
+   size_t pack_size( const T& value ) {
+      datastream<size_t> ps;
+      ps << value;
+      return ps.tellp();
+   }
+
+   template<typename T>
+   std::vector<char> pack( const T& value ) {
+      std::vector<char> result( pack_size(value) );
+      datastream<char*> ds( result.data(), result.size() );
+      ds << value;
+      return result;
+   }
+
+   template<typename T>
+   T unpack( const char* buffer, size_t len ) {
+      T result{};
+      datastream<const char*> ds( buffer, len );
+      ds >> result;
+      return result;
+   }
+
+   template<typename T>
+   T unpack( const std::vector<char>& bytes ) {
+      return unpack<T>( bytes.data(), bytes.size() );
+   }
+
+} /// namespace eosio
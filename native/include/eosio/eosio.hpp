@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * Native host stand-in of the CDT `eosio/eosio.hpp` umbrella header.
+ *
+ * Only the subset of the CDT API used by this contract is provided, backed by the
+ * in-memory chain state in `eosio/host.hpp` so the contract compiles & runs as a
+ * regular Linux binary for benchmarking (see `native/CMakeLists.txt`).
+ */
+#include <eosio/action.hpp>
+#include <eosio/asset.hpp>
+#include <eosio/check.hpp>
+#include <eosio/contract.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/symbol.hpp>
+#include <eosio/system.hpp>
+#include <eosio/time.hpp>
+
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
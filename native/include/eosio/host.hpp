@@ -0,0 +1,136 @@
+#pragma once
+
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * In-memory chain state backing the native stand-ins (database, authorizations, action context).
+ *
+ * Hosts drive the contract by setting the action context, calling the action handler on a
+ * contract instance, then inspecting the database, the captured inline actions & the counters.
+ */
+namespace eosio::native {
+
+   // (code, scope, table)
+   using table_id = std::tuple<uint64_t, uint64_t, uint64_t>;
+
+   struct row {
+      std::vector<char>    data;
+      uint64_t             payer = 0;
+   };
+
+   struct inline_action {
+      name                                account;
+      name                                action;
+      std::vector<std::pair<name, name>>  authorization;
+      std::vector<char>                   data;
+   };
+
+   struct counters {
+      uint64_t db_reads = 0;        // rows deserialized or read through the raw db API
+      uint64_t db_writes = 0;       // rows stored, updated or removed
+      uint64_t inline_actions = 0;
+      uint64_t notifications = 0;
+      int64_t  ram_bytes = 0;       // net RAM billed to all payers
+   };
+
+   // billable sizes of nodeos database objects (`config::billable_size_v`)
+   static constexpr int64_t TABLE_OVERHEAD = 108;      // table_id_object
+   static constexpr int64_t ROW_OVERHEAD = 108;        // key_value_object, excluding row data
+   static constexpr int64_t INDEX64_OVERHEAD = 128;    // index64_object
+
+   struct chain_state {
+      std::map<table_id, std::map<uint64_t, row>>  db;
+      std::map<table_id, uint64_t>                 table_payers;
+      std::map<name, int64_t>                      ram_usage;
+
+      // undo journal of the current transaction, previous row of every write & RAM billed
+      bool                                                                    journaling = false;
+      std::vector<std::tuple<table_id, uint64_t, std::optional<row>>>         undo_rows;
+      std::vector<std::pair<uint64_t, int64_t>>                               undo_bills;
+      std::vector<std::pair<table_id, uint64_t>>   db_iterators;
+
+      std::set<name>             accounts;
+      std::set<name>             authorizations;
+      name                       receiver;
+      name                       first_receiver;
+      name                       sender;
+      std::vector<char>          action_data;
+      std::vector<char>          return_value;
+      std::vector<name>          recipients;
+      std::vector<inline_action> inline_actions;
+      block_timestamp            block_time;
+      counters                   stats;
+
+      std::map<uint64_t, row>& table( uint64_t code, uint64_t scope, uint64_t table ) {
+         return db[{code, scope, table}];
+      }
+
+      void bill( uint64_t payer, int64_t bytes ) {
+         ram_usage[name(payer)] += bytes;
+         stats.ram_bytes += bytes;
+         if ( journaling ) undo_bills.emplace_back( payer, bytes );
+      }
+
+      // record the current value of a row before it is written
+      void journal( const table_id& id, uint64_t pk ) {
+         if ( !journaling ) return;
+         const auto& rows = db[id];
+         const auto itr = rows.find( pk );
+         undo_rows.emplace_back( id, pk, itr == rows.end() ? std::nullopt : std::optional<row>( itr->second ) );
+      }
+
+      void begin_transaction() {
+         journaling = true;
+         undo_rows.clear();
+         undo_bills.clear();
+      }
+
+      void commit_transaction() {
+         journaling = false;
+         undo_rows.clear();
+         undo_bills.clear();
+      }
+
+      // restore all rows & RAM usage written since `begin_transaction`
+      void rollback_transaction() {
+         for ( auto itr = undo_rows.rbegin(); itr != undo_rows.rend(); ++itr ) {
+            auto& [id, pk, previous] = *itr;
+            if ( previous ) db[id][pk] = std::move( *previous );
+            else db[id].erase( pk );
+         }
+         for ( const auto& [payer, bytes] : undo_bills ) {
+            ram_usage[name(payer)] -= bytes;
+            stats.ram_bytes -= bytes;
+         }
+         commit_transaction();
+      }
+
+      // reset the per action context, database & accounts are kept
+      void begin_action( name receiver_, name first_receiver_, std::vector<name> auths, std::vector<char> data ) {
+         receiver = receiver_;
+         first_receiver = first_receiver_;
+         authorizations = std::set<name>( auths.begin(), auths.end() );
+         sender = name();
+         action_data = std::move(data);
+         return_value.clear();
+         recipients.clear();
+         inline_actions.clear();
+         db_iterators.clear();
+      }
+   };
+
+   inline chain_state& state() {
+      static chain_state s;
+      return s;
+   }
+
+} /// namespace eosio::native
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/host.hpp>
+#include <eosio/name.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eosio {
+
+   constexpr static inline name same_payer{};
+
+   /**
+    * Native stand-in of `eosio::indexed_by`.
+    */
+   template<name::raw IndexName, typename Extractor>
+   struct indexed_by {
+      static constexpr uint64_t index_name = static_cast<uint64_t>(IndexName);
+      typedef Extractor secondary_extractor_type;
+   };
+
+   /**
+    * Native stand-in of `eosio::const_mem_fun`.
+    */
+   template<class Class, typename Type, Type (Class::*PtrToMemberFunction)() const>
+   struct const_mem_fun {
+      typedef typename std::remove_reference<Type>::type result_type;
+
+      Type operator()( const Class& x ) const { return (x.*PtrToMemberFunction)(); }
+   };
+
+   namespace internal_use_do_not_use {
+
+      inline int32_t db_find_i64( uint64_t code, uint64_t scope, uint64_t table, uint64_t id ) {
+         auto& s = native::state();
+         s.stats.db_reads++;
+         const auto tbl = s.db.find( {code, scope, table} );
+         if ( tbl == s.db.end() || tbl->second.count(id) == 0 ) return -1;
+         s.db_iterators.emplace_back( native::table_id{code, scope, table}, id );
+         return static_cast<int32_t>( s.db_iterators.size() - 1 );
+      }
+
+      inline int32_t db_get_i64( int32_t iterator, const void* data, uint32_t len ) {
+         auto& s = native::state();
+         check( iterator >= 0 && size_t(iterator) < s.db_iterators.size(), "invalid db iterator" );
+         const auto& [id, pk] = s.db_iterators[iterator];
+         const auto& bytes = s.db.at(id).at(pk).data;
+         if ( len == 0 ) return bytes.size();
+         const uint32_t size = std::min<uint32_t>( len, bytes.size() );
+         std::memcpy( const_cast<void*>(data), bytes.data(), size );
+         return size;
+      }
+
+   } /// namespace internal_use_do_not_use
+
+   /**
+    * Native stand-in of `eosio::multi_index` over the in-memory chain state.
+    *
+    * Rows are stored packed, like on chain, and deserialized into a per instance object cache,
+    * so references returned by `get()` & iterators stay valid until the row is erased.
+    * Secondary indices are computed on demand from the stored rows.
+    */
+   template<name::raw TableName, typename T, typename... Indices>
+   class multi_index {
+      public:
+         class const_iterator {
+            public:
+               using iterator_category = std::bidirectional_iterator_tag;
+               using value_type = T;
+               using difference_type = std::ptrdiff_t;
+               using pointer = const T*;
+               using reference = const T&;
+
+               const_iterator() = default;
+
+               const T& operator*() const { return *_idx->load( *_pk ); }
+               const T* operator->() const { return _idx->load( *_pk ); }
+
+               const_iterator& operator++() {
+                  check( _pk.has_value(), "cannot increment end iterator" );
+                  const auto& rows = _idx->rows();
+                  const auto next = rows.upper_bound( *_pk );
+                  _pk = next == rows.end() ? std::nullopt : std::optional<uint64_t>( next->first );
+                  return *this;
+               }
+
+               const_iterator& operator--() {
+                  const auto& rows = _idx->rows();
+                  auto prev = _pk ? rows.lower_bound( *_pk ) : rows.end();
+                  check( prev != rows.begin(), "cannot decrement iterator at beginning of table" );
+                  _pk = (--prev)->first;
+                  return *this;
+               }
+
+               const_iterator operator++( int ) { auto result = *this; ++(*this); return result; }
+               const_iterator operator--( int ) { auto result = *this; --(*this); return result; }
+
+               friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._pk == b._pk; }
+               friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._pk != b._pk; }
+
+            private:
+               friend class multi_index;
+               const_iterator( const multi_index* idx, std::optional<uint64_t> pk ) : _idx(idx), _pk(pk) {}
+
+               const multi_index*       _idx = nullptr;
+               std::optional<uint64_t>  _pk;
+         };
+
+         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+         template<typename Extractor>
+         class secondary_index {
+            public:
+               using secondary_key_type = typename Extractor::result_type;
+
+               class const_iterator {
+                  public:
+                     using iterator_category = std::bidirectional_iterator_tag;
+                     using value_type = T;
+                     using difference_type = std::ptrdiff_t;
+                     using pointer = const T*;
+                     using reference = const T&;
+
+                     const_iterator() = default;
+
+                     const T& operator*() const { return *_idx->_mi->load( _idx->_keys[_pos].second ); }
+                     const T* operator->() const { return &**this; }
+
+                     const_iterator& operator++() { ++_pos; return *this; }
+                     const_iterator& operator--() { --_pos; return *this; }
+                     const_iterator operator++( int ) { auto result = *this; ++_pos; return result; }
+                     const_iterator operator--( int ) { auto result = *this; --_pos; return result; }
+
+                     friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._pos == b._pos; }
+                     friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._pos != b._pos; }
+
+                  private:
+                     friend class secondary_index;
+                     const_iterator( const secondary_index* idx, size_t pos ) : _idx(idx), _pos(pos) {}
+
+                     const secondary_index*  _idx = nullptr;
+                     size_t                  _pos = 0;
+               };
+
+               using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+               explicit secondary_index( const multi_index* mi ) : _mi(mi) {
+                  for ( const auto& [pk, r] : mi->rows() ) _keys.emplace_back( Extractor()( *mi->load(pk) ), pk );
+                  std::sort( _keys.begin(), _keys.end() );
+               }
+
+               const_iterator cbegin() const { return const_iterator( this, 0 ); }
+               const_iterator begin() const { return cbegin(); }
+               const_iterator cend() const { return const_iterator( this, _keys.size() ); }
+               const_iterator end() const { return cend(); }
+               const_reverse_iterator rbegin() const { return const_reverse_iterator( cend() ); }
+               const_reverse_iterator rend() const { return const_reverse_iterator( cbegin() ); }
+
+               const_iterator lower_bound( const secondary_key_type& key ) const {
+                  const auto itr = std::lower_bound( _keys.begin(), _keys.end(), std::make_pair( key, uint64_t(0) ) );
+                  return const_iterator( this, size_t(itr - _keys.begin()) );
+               }
+
+               const_iterator upper_bound( const secondary_key_type& key ) const {
+                  const auto itr = std::upper_bound( _keys.begin(), _keys.end(), std::make_pair( key, ~uint64_t(0) ) );
+                  return const_iterator( this, size_t(itr - _keys.begin()) );
+               }
+
+               const_iterator find( const secondary_key_type& key ) const {
+                  const auto itr = lower_bound( key );
+                  return itr != end() && Extractor()( *itr ) == key ? itr : end();
+               }
+
+            private:
+               const multi_index*                                      _mi;
+               std::vector<std::pair<secondary_key_type, uint64_t>>    _keys;
+         };
+
+         multi_index( name code, uint64_t scope ) : _code(code), _scope(scope) {}
+
+         name get_code() const { return _code; }
+         uint64_t get_scope() const { return _scope; }
+
+         const_iterator cbegin() const {
+            const auto& r = rows();
+            return r.empty() ? cend() : const_iterator( this, r.begin()->first );
+         }
+         const_iterator begin() const { return cbegin(); }
+         const_iterator cend() const { return const_iterator( this, std::nullopt ); }
+         const_iterator end() const { return cend(); }
+         const_reverse_iterator rbegin() const { return const_reverse_iterator( cend() ); }
+         const_reverse_iterator rend() const { return const_reverse_iterator( cbegin() ); }
+
+         const_iterator lower_bound( uint64_t primary ) const {
+            const auto& r = rows();
+            const auto itr = r.lower_bound( primary );
+            return itr == r.end() ? cend() : const_iterator( this, itr->first );
+         }
+
+         const_iterator upper_bound( uint64_t primary ) const {
+            const auto& r = rows();
+            const auto itr = r.upper_bound( primary );
+            return itr == r.end() ? cend() : const_iterator( this, itr->first );
+         }
+
+         const_iterator find( uint64_t primary ) const {
+            native::state().stats.db_reads++;
+            return rows().count( primary ) ? const_iterator( this, primary ) : cend();
+         }
+
+         const_iterator require_find( uint64_t primary, const char* error_msg = "unable to find key" ) const {
+            const auto itr = find( primary );
+            check( itr != cend(), error_msg );
+            return itr;
+         }
+
+         const T& get( uint64_t primary, const char* error_msg = "unable to find key" ) const {
+            return *require_find( primary, error_msg );
+         }
+
+         template<typename Lambda>
+         const_iterator emplace( name payer, Lambda&& constructor ) {
+            T obj{};
+            constructor( obj );
+
+            const uint64_t pk = obj.primary_key();
+            auto& r = rows();
+            check( r.count(pk) == 0, "could not insert object, most likely a uniqueness constraint was violated" );
+
+            auto& s = native::state();
+            s.journal( table_id(), pk );
+            if ( r.empty() ) {
+               s.table_payers[table_id()] = payer.value;
+               s.bill( payer.value, native::TABLE_OVERHEAD * (1 + sizeof...(Indices)) );
+            }
+            r[pk] = native::row{ pack(obj), payer.value };
+            s.bill( payer.value, row_billable_size( r[pk] ) );
+            s.stats.db_writes++;
+
+            _cache[pk] = std::make_unique<T>( std::move(obj) );
+            return const_iterator( this, pk );
+         }
+
+         template<typename Lambda>
+         void modify( const_iterator itr, name payer, Lambda&& updater ) {
+            check( itr != end(), "cannot pass end iterator to modify" );
+            modify( *itr, payer, std::forward<Lambda&&>(updater) );
+         }
+
+         template<typename Lambda>
+         void modify( const T& obj, name payer, Lambda&& updater ) {
+            auto& mutableobj = const_cast<T&>(obj);
+            const uint64_t pk = mutableobj.primary_key();
+            updater( mutableobj );
+            check( pk == mutableobj.primary_key(), "updater cannot change primary key when modifying an object" );
+
+            auto& s = native::state();
+            s.journal( table_id(), pk );
+            auto& stored = rows().at( pk );
+            s.bill( stored.payer, -row_billable_size( stored ) );
+            stored.data = pack( mutableobj );
+            if ( payer.value ) stored.payer = payer.value;
+            s.bill( stored.payer, row_billable_size( stored ) );
+            s.stats.db_writes++;
+         }
+
+         const_iterator erase( const_iterator itr ) {
+            check( itr != end(), "cannot pass end iterator to erase" );
+            auto next = itr;
+            ++next;
+            erase( *itr );
+            return next;
+         }
+
+         void erase( const T& obj ) {
+            const uint64_t pk = obj.primary_key();
+            auto& s = native::state();
+            s.journal( table_id(), pk );
+            auto& r = rows();
+            s.bill( r.at(pk).payer, -row_billable_size( r.at(pk) ) );
+            r.erase( pk );
+            if ( r.empty() ) s.bill( s.table_payers[table_id()], -native::TABLE_OVERHEAD * (1 + sizeof...(Indices)) );
+            _cache.erase( pk );
+            s.stats.db_writes++;
+         }
+
+         template<name::raw IndexName>
+         auto get_index() const {
+            return get_index_impl<static_cast<uint64_t>(IndexName), Indices...>();
+         }
+
+      private:
+         template<uint64_t IndexName, typename Index, typename... Rest>
+         auto get_index_impl() const {
+            if constexpr ( Index::index_name == IndexName ) return secondary_index<typename Index::secondary_extractor_type>( this );
+            else return get_index_impl<IndexName, Rest...>();
+         }
+
+         native::table_id table_id() const {
+            return { _code.value, _scope, static_cast<uint64_t>(TableName) };
+         }
+
+         // primary row & one index64 row per secondary index
+         static int64_t row_billable_size( const native::row& r ) {
+            return native::ROW_OVERHEAD + r.data.size() + native::INDEX64_OVERHEAD * sizeof...(Indices);
+         }
+
+         std::map<uint64_t, native::row>& rows() const {
+            return native::state().table( _code.value, _scope, static_cast<uint64_t>(TableName) );
+         }
+
+         const T* load( uint64_t pk ) const {
+            auto cached = _cache.find( pk );
+            if ( cached != _cache.end() ) return cached->second.get();
+
+            const auto& stored = rows().at( pk );
+            native::state().stats.db_reads++;
+            auto obj = std::make_unique<T>( unpack<T>( stored.data ) );
+            return ( _cache[pk] = std::move(obj) ).get();
+         }
+
+         name                                                  _code;
+         uint64_t                                              _scope;
+         mutable std::map<uint64_t, std::unique_ptr<T>>        _cache;
+   };
+
+} /// namespace eosio
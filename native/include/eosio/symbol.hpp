@@ -0,0 +1,86 @@
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace eosio {
+
+   /**
+    * Native stand-in of `eosio::symbol_code`, up to 7 uppercase characters packed in 64 bits.
+    */
+   class symbol_code {
+      public:
+         constexpr symbol_code() = default;
+         constexpr explicit symbol_code( uint64_t raw ) : value(raw) {}
+
+         constexpr explicit symbol_code( std::string_view str ) {
+            if ( str.size() > 7 ) eosio::check( false, "string is too long to be a valid symbol_code" );
+            for ( auto itr = str.rbegin(); itr != str.rend(); ++itr ) {
+               if ( *itr < 'A' || *itr > 'Z' ) eosio::check( false, "only uppercase letters allowed in symbol_code string" );
+               value <<= 8;
+               value |= *itr;
+            }
+         }
+
+         constexpr bool is_valid() const {
+            auto sym = value;
+            for ( int i = 0; i < 7; ++i ) {
+               const char c = static_cast<char>( sym & 0xFF );
+               if ( !('A' <= c && c <= 'Z') ) return false;
+               sym >>= 8;
+               if ( !(sym & 0xFF) ) {
+                  do {
+                     sym >>= 8;
+                     if ( (sym & 0xFF) ) return false;
+                     ++i;
+                  } while ( i < 7 );
+               }
+            }
+            return true;
+         }
+
+         constexpr uint64_t raw() const { return value; }
+         constexpr explicit operator bool() const { return value != 0; }
+
+         std::string to_string() const {
+            std::string str;
+            for ( auto v = value; v > 0; v >>= 8 ) str += static_cast<char>( v & 0xFF );
+            return str;
+         }
+
+         friend constexpr bool operator==( const symbol_code& a, const symbol_code& b ) { return a.value == b.value; }
+         friend constexpr bool operator!=( const symbol_code& a, const symbol_code& b ) { return a.value != b.value; }
+         friend constexpr bool operator<( const symbol_code& a, const symbol_code& b ) { return a.value < b.value; }
+
+      private:
+         uint64_t value = 0;
+   };
+
+   /**
+    * Native stand-in of `eosio::symbol`, a symbol code & precision packed in 64 bits.
+    */
+   class symbol {
+      public:
+         constexpr symbol() = default;
+         constexpr explicit symbol( uint64_t raw ) : value(raw) {}
+         constexpr symbol( symbol_code sc, uint8_t precision ) : value( (sc.raw() << 8) | precision ) {}
+         constexpr symbol( std::string_view ss, uint8_t precision ) : value( (symbol_code(ss).raw() << 8) | precision ) {}
+
+         constexpr bool is_valid() const { return code().is_valid(); }
+         constexpr uint8_t precision() const { return value & 0xFF; }
+         constexpr symbol_code code() const { return symbol_code{ value >> 8 }; }
+         constexpr uint64_t raw() const { return value; }
+         constexpr explicit operator bool() const { return value != 0; }
+
+         friend constexpr bool operator==( const symbol& a, const symbol& b ) { return a.value == b.value; }
+         friend constexpr bool operator!=( const symbol& a, const symbol& b ) { return a.value != b.value; }
+         friend constexpr bool operator<( const symbol& a, const symbol& b ) { return a.value < b.value; }
+
+      private:
+         uint64_t value = 0;
+   };
+
+} /// namespace eosio
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <eosio/host.hpp>
+#include <eosio/time.hpp>
+
+namespace eosio {
+
+   inline block_timestamp current_block_time() {
+      return native::state().block_time;
+   }
+
+   inline time_point current_time_point() {
+      return native::state().block_time.to_time_point();
+   }
+
+} /// namespace eosio
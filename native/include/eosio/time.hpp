@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+namespace eosio {
+
+   /**
+    * Native stand-in of `eosio::microseconds`.
+    */
+   class microseconds {
+      public:
+         constexpr microseconds() = default;
+         constexpr explicit microseconds( int64_t c ) : _count(c) {}
+         constexpr int64_t count() const { return _count; }
+
+         friend constexpr bool operator==( const microseconds& a, const microseconds& b ) { return a._count == b._count; }
+         friend constexpr bool operator<( const microseconds& a, const microseconds& b ) { return a._count < b._count; }
+
+      private:
+         int64_t _count = 0;
+   };
+
+   /**
+    * Native stand-in of `eosio::time_point`, packed as int64 microseconds.
+    */
+   class time_point {
+      public:
+         constexpr time_point() = default;
+         constexpr explicit time_point( microseconds e ) : elapsed(e) {}
+         constexpr const microseconds& time_since_epoch() const { return elapsed; }
+         constexpr uint32_t sec_since_epoch() const { return static_cast<uint32_t>( elapsed.count() / 1000000 ); }
+
+         friend constexpr bool operator==( const time_point& a, const time_point& b ) { return a.elapsed == b.elapsed; }
+         friend constexpr bool operator<( const time_point& a, const time_point& b ) { return a.elapsed < b.elapsed; }
+
+         microseconds elapsed;
+   };
+
+   /**
+    * Native stand-in of `eosio::block_timestamp`, packed as uint32 half-second slots since 2000-01-01.
+    */
+   class block_timestamp {
+      public:
+         static constexpr int32_t block_interval_ms = 500;
+         static constexpr int64_t block_timestamp_epoch = 946684800000ll;
+
+         constexpr block_timestamp() = default;
+         constexpr explicit block_timestamp( uint32_t s ) : slot(s) {}
+
+         constexpr time_point to_time_point() const {
+            return time_point( microseconds( ( int64_t(slot) * block_interval_ms + block_timestamp_epoch ) * 1000 ) );
+         }
+
+         friend constexpr bool operator==( const block_timestamp& a, const block_timestamp& b ) { return a.slot == b.slot; }
+         friend constexpr bool operator!=( const block_timestamp& a, const block_timestamp& b ) { return a.slot != b.slot; }
+         friend constexpr bool operator<( const block_timestamp& a, const block_timestamp& b ) { return a.slot < b.slot; }
+
+         uint32_t slot = 0;
+   };
+
+} /// namespace eosio
@@ -0,0 +1,68 @@
+namespace eosio {
+
+[[eosio::action]]
+wram::audit_result wram::audit( const name cursor, const uint32_t limit )
+{
+   check( limit > 0 && limit <= 1000, "limit must be between 1 and 1000" );
+
+   // mirror first, supply adjustments of visited holders are applied to the audit in progress
+   const int64_t total_ram_bytes_reserved = mirror_system_ram();
+
+   auditstate _auditstate( get_self(), get_self().value );
+   auditstate_row state;
+   if ( cursor.value ) {
+      check( _auditstate.exists(), "no audit in progress, start with an empty cursor" );
+      state = _auditstate.get();
+      check( cursor == state.next, "cursor does not match the audit in progress" );
+
+   // restarting discards the audit in progress, only once abandoned or by the contract
+   } else if ( _auditstate.exists() && !has_auth( get_self() ) ) {
+      const block_timestamp updated = _auditstate.get().updated;
+      check( current_block_time().slot - updated.slot >= AUDIT_TIMEOUT, "audit in progress, continue from its cursor" );
+   }
+   state.updated = current_block_time();
+
+   holders _holders( get_self(), get_self().value );
+   auto itr = _holders.lower_bound( state.next.value );
+   for ( uint32_t i = 0; i < limit && itr != _holders.end(); ++i, ++itr ) {
+      const auto balance = find_balance( get_self(), itr->owner, RAM_SYMBOL.code() );
+      const int64_t amount = balance ? balance->amount : 0;
+      if ( amount != itr->balance ) state.mismatches++;
+      state.balances += amount;
+      state.holders++;
+   }
+
+   // more holders to visit
+   if ( itr != _holders.end() ) {
+      state.next = itr->owner;
+      _auditstate.set( state, get_self() );
+      return { state.next, state.balances, state.holders, state.mismatches, false };
+   }
+
+   // finished, supply already mirrors system RAM within this action
+   _auditstate.remove();
+   const int64_t supply = get_supply( get_self(), RAM_SYMBOL.code() ).amount;
+   const bool balanced = state.balances == supply && supply == total_ram_bytes_reserved && state.mismatches == 0;
+
+   auditresult _auditresult( get_self(), get_self().value );
+   _auditresult.set( { state.balances, supply, total_ram_bytes_reserved, state.holders, state.mismatches, balanced, current_block_time() }, get_self() );
+   return { name(), state.balances, state.holders, state.mismatches, balanced };
+}
+
+// keep the running sum of the audit in progress for holders it already visited
+void wram::audit_balance_changed( const name& owner, const int64_t delta )
+{
+   if ( delta == 0 ) return;
+
+   // `audit` changes no balances after starting or finishing an audit, the flag holds for the whole action
+   auditstate _auditstate( get_self(), get_self().value );
+   if ( !_auditing ) _auditing = _auditstate.exists();
+   if ( !*_auditing ) return;
+
+   auto state = _auditstate.get();
+   if ( owner.value >= state.next.value ) return; // not yet visited
+   state.balances += delta;
+   _auditstate.set( state, get_self() );
+}
+
+} /// namespace eosio
@@ -1,18 +1,18 @@
 namespace eosio {
+    // bloom filter bit of an egress account (fibonacci hashing to 6 bits)
+    static uint64_t egress_filter_bit( const name account )
+    {
+        return 1ULL << ((account.value * 0x9E3779B97F4A7C15ULL) >> 58);
+    }
+
     [[eosio::action]]
     void wram::addegress( const set<name> accounts )
     {
         require_auth(get_self());
 
-        egresslist _egresslist(get_self(), get_self().value);
-
-        for (const name account : accounts) {
-            auto itr = _egresslist.find(account.value);
-            if (itr != _egresslist.end() ) continue; // skip if already exists
-            _egresslist.emplace(get_self(), [&](auto& row) {
-                row.account = account;
-            });
-        }
+        set<name> egress = get_egress_accounts();
+        egress.insert(accounts.begin(), accounts.end());
+        set_egress_accounts(egress);
     }
 
     [[eosio::action]]
@@ -20,22 +20,78 @@ namespace eosio {
     {
         require_auth(get_self());
 
+        set<name> egress = get_egress_accounts();
+        for (const name account : accounts) {
+            egress.erase(account);
+        }
+        set_egress_accounts(egress);
+    }
+
+    // load egress accounts, folding any legacy `egresslist` rows into the set
+    set<name> wram::get_egress_accounts()
+    {
+        set<name> egress;
+
+        egressset _egressset(get_self(), get_self().value);
+        if (_egressset.exists()) {
+            const auto row = _egressset.get();
+            egress.insert(row.accounts.begin(), row.accounts.end());
+        }
+
         egresslist _egresslist(get_self(), get_self().value);
+        for (auto itr = _egresslist.begin(); itr != _egresslist.end(); ) {
+            egress.insert(itr->account);
+            itr = _egresslist.erase(itr);
+        }
+        return egress;
+    }
 
+    // rewrite the packed egress row in a single pass (set is already sorted)
+    void wram::set_egress_accounts( const set<name>& accounts )
+    {
+        egressset_row row;
+        row.accounts.reserve(accounts.size());
         for (const name account : accounts) {
-            auto itr = _egresslist.find(account.value);
-            if (itr == _egresslist.end() ) continue; // skip if not exists
-            _egresslist.erase(itr);
+            row.accounts.push_back(account);
+            row.filter |= egress_filter_bit(account);
         }
+
+        egressset _egressset(get_self(), get_self().value);
+        _egressset.set(row, get_self());
     }
 
     // block transfers to any account in the egress list
     void wram::check_disable_transfer( const name receiver )
     {
         if (receiver == get_self()) { return; } // ignore self transfer (eosio.wram)
+        check_disable_transfer(receiver, get_egress_row());
+    }
+
+    // packed egress row, empty before the legacy egress list is migrated
+    std::optional<wram::egressset_row> wram::get_egress_row()
+    {
+        egressset _egressset(get_self(), get_self().value);
+        if (!_egressset.exists()) { return {}; }
+        return _egressset.get();
+    }
+
+    // block transfers to any account in the egress list, `egress` is loaded once per action by `get_egress_row`
+    void wram::check_disable_transfer( const name receiver, const std::optional<egressset_row>& egress )
+    {
+        if (receiver == get_self()) { return; } // ignore self transfer (eosio.wram)
+        WRAM_METRIC( egress_checks, 1 );
+
+        if (egress) {
+            if ((egress->filter & egress_filter_bit(receiver)) == 0) { return; } // definite miss
+            WRAM_METRIC( egress_searches, 1 );
+            check( !binary_search(egress->accounts.begin(), egress->accounts.end(), receiver), "transfer disabled to account" );
+            return;
+        }
 
+        // legacy egress list (not yet migrated)
+        WRAM_METRIC( egress_searches, 1 );
         egresslist _egresslist(get_self(), get_self().value);
         auto itr = _egresslist.find(receiver.value);
         check( itr == _egresslist.end(), "transfer disabled to account" );
     }
-}
\ No newline at end of file
+}
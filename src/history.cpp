@@ -0,0 +1,65 @@
+namespace eosio {
+
+// record supply & system RAM in the `history` ring buffer, one record per block
+// the latest record is updated in place within a block, older rows are reused once the buffer is full
+void wram::update_history( const int64_t supply, const int64_t total_ram_bytes_reserved, const int64_t wrapped, const int64_t unwrapped )
+{
+   const block_timestamp now = current_block_time();
+   historystate _historystate( get_self(), get_self().value );
+   auto state = _historystate.get_or_default();
+   history _history( get_self(), get_self().value );
+
+   int64_t total_wrapped = wrapped;
+   int64_t total_unwrapped = unwrapped;
+   if ( state.next > 0 ) {
+      const auto& last = _history.get( (state.next - 1) % HISTORY_SIZE, "history record does not exist" );
+      if ( last.time == now ) {
+         if ( last.supply == supply && last.total_ram_bytes_reserved == total_ram_bytes_reserved && wrapped == 0 && unwrapped == 0 ) return;
+         _history.modify( last, same_payer, [&]( auto& r ) {
+            r.supply = supply;
+            r.total_ram_bytes_reserved = total_ram_bytes_reserved;
+            r.wrapped += wrapped;
+            r.unwrapped += unwrapped;
+         });
+         return;
+      }
+      total_wrapped += last.wrapped;
+      total_unwrapped += last.unwrapped;
+   }
+
+   const auto write = [&]( auto& r ) {
+      r.seq = state.next;
+      r.time = now;
+      r.supply = supply;
+      r.total_ram_bytes_reserved = total_ram_bytes_reserved;
+      r.wrapped = total_wrapped;
+      r.unwrapped = total_unwrapped;
+   };
+   const auto itr = _history.find( state.next % HISTORY_SIZE );
+   if ( itr == _history.end() ) _history.emplace( get_self(), write );
+   else _history.modify( itr, same_payer, write );
+
+   state.next++;
+   _historystate.set( state, get_self() );
+}
+
+[[eosio::action, eosio::read_only]]
+wram::history_result wram::gethistory( const uint64_t from, const uint32_t limit )
+{
+   check( limit > 0 && limit <= 1000, "limit must be between 1 and 1000" );
+
+   historystate _historystate( get_self(), get_self().value );
+   const uint64_t next = _historystate.get_or_default().next;
+   history _history( get_self(), get_self().value );
+
+   // skip records already overwritten
+   const uint64_t oldest = next > HISTORY_SIZE ? next - HISTORY_SIZE : 0;
+   history_result result;
+   result.next = std::max( from, oldest );
+   for ( ; result.next < next && result.records.size() < limit; ++result.next ) {
+      result.records.push_back( _history.get( result.next % HISTORY_SIZE, "history record does not exist" ) );
+   }
+   return result;
+}
+
+} /// namespace eosio
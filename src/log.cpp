@@ -0,0 +1,23 @@
+namespace eosio {
+
+[[eosio::action]]
+void wram::logwrap( const name account, const int64_t delta, const int64_t balance, const int64_t supply, const int64_t total_ram_bytes_reserved )
+{
+   require_auth( get_self() );
+   require_recipient( account );
+}
+
+[[eosio::action]]
+void wram::logunwrap( const name account, const int64_t delta, const int64_t balance, const int64_t supply, const int64_t total_ram_bytes_reserved )
+{
+   require_auth( get_self() );
+   require_recipient( account );
+}
+
+[[eosio::action]]
+void wram::logmirror( const name account, const int64_t delta, const int64_t balance, const int64_t supply, const int64_t total_ram_bytes_reserved )
+{
+   require_auth( get_self() );
+}
+
+} /// namespace eosio
@@ -0,0 +1,66 @@
+namespace eosio {
+
+// system RAM market conversion (see `exchange_state::get_bancor_output`)
+static int64_t get_bancor_output( const int64_t inp_reserve, const int64_t out_reserve, const int64_t inp )
+{
+   const double ib = inp_reserve;
+   const double ob = out_reserve;
+   const double in = inp;
+
+   int64_t out = int64_t( (in * ob) / (ib + in) );
+   if ( out < 0 ) out = 0;
+   return out;
+}
+
+// .5% system RAM fee (round up)
+static int64_t get_ram_fee( const int64_t amount )
+{
+   return ( amount + 199 ) / 200;
+}
+
+// bytes received by `buyram` of `quantity` core tokens
+asset wram::quote_buyram( const asset& quantity )
+{
+   eosiosystem::system_contract::rammarket _rammarket( "eosio"_n, "eosio"_n.value );
+   const auto& market = _rammarket.get( eosiosystem::system_contract::ramcore_symbol.raw(), "ram market does not exist" );
+   check( quantity.symbol == market.quote.balance.symbol, "must buy ram with core symbol" );
+   check( quantity.amount > 0, "must purchase a positive amount" );
+
+   const int64_t quantity_after_fee = quantity.amount - get_ram_fee( quantity.amount );
+   const int64_t bytes = get_bancor_output( market.quote.balance.amount, market.base.balance.amount, quantity_after_fee );
+   return asset{ bytes, RAM_SYMBOL };
+}
+
+// core tokens received by `sellram` of `bytes`
+asset wram::quote_sellram( const int64_t bytes )
+{
+   eosiosystem::system_contract::rammarket _rammarket( "eosio"_n, "eosio"_n.value );
+   const auto& market = _rammarket.get( eosiosystem::system_contract::ramcore_symbol.raw(), "ram market does not exist" );
+   check( bytes > 0, "cannot sell negative byte" );
+
+   const int64_t tokens_out = get_bancor_output( market.base.balance.amount, market.quote.balance.amount, bytes );
+   check( tokens_out > 1, "token amount received from selling ram is too low" );
+   return asset{ tokens_out - get_ram_fee( tokens_out ), market.quote.balance.symbol };
+}
+
+// contract balance of the core token (`eosio.token` accounts share the legacy balance row layout)
+asset wram::get_core_balance( const symbol& sym )
+{
+   accounts _accounts( "eosio.token"_n, get_self().value );
+   const auto itr = _accounts.find( sym.code().raw() );
+   return itr == _accounts.end() ? asset{0, sym} : itr->balance;
+}
+
+[[eosio::action, eosio::read_only]]
+asset wram::quotewrap( const asset quantity )
+{
+   return quote_buyram( quantity );
+}
+
+[[eosio::action, eosio::read_only]]
+asset wram::quotesell( const int64_t bytes )
+{
+   return quote_sellram( bytes );
+}
+
+} /// namespace eosio
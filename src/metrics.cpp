@@ -0,0 +1,29 @@
+#ifdef WRAM_METRICS
+namespace eosio {
+
+wram::~wram()
+{
+   if ( !_metrics_dirty ) return;
+
+   metrics _metrics_table( get_self(), get_self().value );
+   auto row = _metrics_table.get_or_default();
+   row.mirror_issues += _metrics.mirror_issues;
+   row.mirror_retires += _metrics.mirror_retires;
+   row.mirror_issued += _metrics.mirror_issued;
+   row.mirror_retired += _metrics.mirror_retired;
+   row.egress_checks += _metrics.egress_checks;
+   row.egress_searches += _metrics.egress_searches;
+   row.balance_emplaces += _metrics.balance_emplaces;
+   row.balance_modifies += _metrics.balance_modifies;
+   _metrics_table.set( row, get_self() );
+}
+
+[[eosio::action, eosio::read_only]]
+wram::metrics_row wram::getmetrics()
+{
+   metrics _metrics_table( get_self(), get_self().value );
+   return _metrics_table.get_or_default();
+}
+
+} /// namespace eosio
+#endif
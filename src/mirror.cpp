@@ -1,5 +1,9 @@
 namespace eosio {
 
+// packed layout of the system `global` row (see `eosio_global_state`)
+static constexpr uint32_t GLOBAL_RAM_OFFSET = 68;   // blockchain parameters preceding `max_ram_size`
+static constexpr uint32_t GLOBAL_STATE_SIZE = 154;  // packed size of `eosio_global_state`
+
 eosiosystem::system_contract::eosio_global_state wram::get_global()
 {
    eosiosystem::system_contract::global_state_singleton _global( "eosio"_n, "eosio"_n.value );
@@ -8,23 +12,68 @@ eosiosystem::system_contract::eosio_global_state wram::get_global()
    return global;
 }
 
-void wram::mirror_system_ram()
+// decode only `max_ram_size` & `total_ram_bytes_reserved` from the raw `global` row
+// falls back to full deserialization if the row does not match the expected layout
+wram::global_ram wram::get_global_ram()
+{
+   const uint64_t system = "eosio"_n.value;
+   const uint64_t table = "global"_n.value;
+   const int32_t itr = internal_use_do_not_use::db_find_i64( system, system, table, table );
+   check( itr >= 0, "global state does not exist" );
+
+   const int32_t size = internal_use_do_not_use::db_get_i64( itr, nullptr, 0 );
+   if ( size != GLOBAL_STATE_SIZE ) {
+      const auto global = get_global();
+      return { static_cast<int64_t>(global.max_ram_size), static_cast<int64_t>(global.total_ram_bytes_reserved) };
+   }
+
+   char buffer[GLOBAL_STATE_SIZE];
+   internal_use_do_not_use::db_get_i64( itr, buffer, GLOBAL_STATE_SIZE );
+
+   global_ram ram;
+   datastream<const char*> ds( buffer + GLOBAL_RAM_OFFSET, sizeof(ram) );
+   ds >> ram.max_ram_size;
+   ds >> ram.total_ram_bytes_reserved;
+   return ram;
+}
+
+// returns the system RAM reserved bytes, equal to WRAM supply after mirroring
+// `wrapped` & `unwrapped` bytes of the calling action are added to the `history` totals
+int64_t wram::mirror_system_ram( const int64_t wrapped, const int64_t unwrapped )
 {
-   auto global = get_global();
-   const int64_t total_ram_bytes_reserved = global.total_ram_bytes_reserved;
-   const asset supply = get_supply(get_self(), RAM_SYMBOL.code());
-   const int64_t delta = total_ram_bytes_reserved - supply.amount;
+   const int64_t total_ram_bytes_reserved = get_global_ram().total_ram_bytes_reserved;
+   stats statstable( get_self(), RAM_SYMBOL_CODE );
+   const auto& st = statstable.get( RAM_SYMBOL_CODE, "invalid supply symbol code" );
+   const int64_t delta = total_ram_bytes_reserved - st.supply.amount;
+   if ( delta == 0 ) {
+      update_history( total_ram_bytes_reserved, total_ram_bytes_reserved, wrapped, unwrapped );
+      return total_ram_bytes_reserved;
+   }
 
    // issue supply
+   int64_t balance;
    if (delta > 0) {
-      issue_action issue_act{get_self(), {get_self(), "active"_n}};
-      issue_act.send(get_self(), asset{delta, RAM_SYMBOL}, "mirror ram");
+      check( delta <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
+      balance = add_balance( get_self(), asset{delta, RAM_SYMBOL}, get_self() );
+      WRAM_METRIC( mirror_issues, 1 );
+      WRAM_METRIC( mirror_issued, delta );
 
    // retire supply
-   } else if (delta < 0) {
-      retire_action retire_act{get_self(), {get_self(), "active"_n}};
-      retire_act.send(asset{-delta, RAM_SYMBOL}, "mirror ram");
+   } else {
+      balance = sub_balance( get_self(), asset{-delta, RAM_SYMBOL}, get_self() );
+      WRAM_METRIC( mirror_retires, 1 );
+      WRAM_METRIC( mirror_retired, -delta );
    }
+
+   statstable.modify( st, same_payer, [&]( auto& s ) {
+      s.supply.amount += delta;
+   });
+   update_history( total_ram_bytes_reserved, total_ram_bytes_reserved, wrapped, unwrapped );
+
+   // log supply adjustment
+   logmirror_action logmirror_act{get_self(), {get_self(), "active"_n}};
+   logmirror_act.send(get_self(), delta, balance, st.supply.amount, total_ram_bytes_reserved);
+   return total_ram_bytes_reserved;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+namespace eosio {
+
+[[eosio::action, eosio::read_only]]
+wram::getbalances_result wram::getbalances( const vector<name> owners )
+{
+   const auto global = get_global_ram();
+
+   getbalances_result result;
+   result.supply = get_supply( get_self(), RAM_SYMBOL.code() );
+   result.total_ram_bytes_reserved = global.total_ram_bytes_reserved;
+   result.max_ram_size = global.max_ram_size;
+
+   result.balances.reserve( owners.size() );
+   for ( const name owner : owners ) {
+      const auto balance = find_balance( get_self(), owner, RAM_SYMBOL.code() );
+      result.balances.push_back({ owner, balance.value_or( asset{0, RAM_SYMBOL} ) });
+   }
+   return result;
+}
+
+[[eosio::action, eosio::read_only]]
+wram::listholders_result wram::listholders( const name cursor, const uint32_t limit )
+{
+   check( limit > 0 && limit <= 1000, "limit must be between 1 and 1000" );
+
+   listholders_result result;
+   holders _holders( get_self(), get_self().value );
+   auto itr = _holders.lower_bound( cursor.value );
+   for ( ; itr != _holders.end() && result.holders.size() < limit; ++itr ) {
+      result.holders.push_back( *itr );
+   }
+   if ( itr != _holders.end() ) result.next = itr->owner;
+   return result;
+}
+
+[[eosio::action, eosio::read_only]]
+vector<wram::holders_row> wram::topholders( const uint32_t n )
+{
+   check( n > 0 && n <= 1000, "n must be between 1 and 1000" );
+
+   vector<holders_row> result;
+   holders _holders( get_self(), get_self().value );
+   auto idx = _holders.get_index<"bybalance"_n>();
+   for ( auto itr = idx.rbegin(); itr != idx.rend() && result.size() < n; ++itr ) {
+      result.push_back( *itr );
+   }
+   return result;
+}
+
+} /// namespace eosio
@@ -19,7 +19,7 @@ void wram::create( const name& issuer, const asset&  maximum_supply )
     });
 
     // max supply must match system RAM
-    const auto global = get_global();
+    const auto global = get_global_ram();
     check( maximum_supply.amount == global.max_ram_size, "maximum supply must match system max RAM size" );
     check( maximum_supply.symbol == RAM_SYMBOL, "symbol must be WRAM" );
 
@@ -30,12 +30,11 @@ void wram::create( const name& issuer, const asset&  maximum_supply )
 
 void wram::issue( const name& to, const asset& quantity, const string& memo )
 {
-    auto sym = quantity.symbol;
-    check( sym.is_valid(), "invalid symbol name" );
+    check( quantity.symbol == RAM_SYMBOL, "symbol precision mismatch" );
     check( memo.size() <= 256, "memo has more than 256 bytes" );
 
-    stats statstable( get_self(), sym.code().raw() );
-    auto existing = statstable.find( sym.code().raw() );
+    stats statstable( get_self(), RAM_SYMBOL_CODE );
+    auto existing = statstable.find( RAM_SYMBOL_CODE );
     check( existing != statstable.end(), "token with symbol does not exist, create token before issue" );
     const auto& st = *existing;
     check( to == st.issuer, "tokens can only be issued to issuer account" );
@@ -44,8 +43,6 @@ void wram::issue( const name& to, const asset& quantity, const string& memo )
     check( get_sender() == get_self(), "must be executed by contract");
     check( quantity.is_valid(), "invalid quantity" );
     check( quantity.amount > 0, "must issue positive quantity" );
-
-    check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
     check( quantity.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
 
     statstable.modify( st, same_payer, [&]( auto& s ) {
@@ -57,12 +54,11 @@ void wram::issue( const name& to, const asset& quantity, const string& memo )
 
 void wram::retire( const asset& quantity, const string& memo )
 {
-    auto sym = quantity.symbol;
-    check( sym.is_valid(), "invalid symbol name" );
+    check( quantity.symbol == RAM_SYMBOL, "symbol precision mismatch" );
     check( memo.size() <= 256, "memo has more than 256 bytes" );
 
-    stats statstable( get_self(), sym.code().raw() );
-    auto existing = statstable.find( sym.code().raw() );
+    stats statstable( get_self(), RAM_SYMBOL_CODE );
+    auto existing = statstable.find( RAM_SYMBOL_CODE );
     check( existing != statstable.end(), "token with symbol does not exist" );
     const auto& st = *existing;
 
@@ -71,73 +67,273 @@ void wram::retire( const asset& quantity, const string& memo )
     check( quantity.is_valid(), "invalid quantity" );
     check( quantity.amount > 0, "must retire positive quantity" );
 
-    check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
-
     statstable.modify( st, same_payer, [&]( auto& s ) {
        s.supply -= quantity;
     });
 
-    sub_balance( st.issuer, quantity );
+    sub_balance( st.issuer, quantity, st.issuer );
 }
 
-void wram::transfer( const name&    from,
-                      const name&    to,
-                      const asset&   quantity,
-                      const string&  memo )
+wram::transfer_result wram::transfer( const name&    from,
+                                     const name&    to,
+                                     const asset&   quantity,
+                                     const string&  memo )
 {
     check( from != to, "cannot transfer to self" );
     require_auth( from );
     check( is_account( to ), "to account does not exist");
-    auto sym = quantity.symbol.code();
-    stats statstable( get_self(), sym.raw() );
-    const auto& st = statstable.get( sym.raw() );
 
     require_recipient( from );
     require_recipient( to );
 
+    // supply is not needed, symbol is validated against the compile-time WRAM symbol
+    check( quantity.symbol == RAM_SYMBOL, "symbol precision mismatch" );
     check( quantity.is_valid(), "invalid quantity" );
     check( quantity.amount > 0, "must transfer positive quantity" );
-    check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
     check( memo.size() <= 256, "memo has more than 256 bytes" );
 
     auto payer = has_auth( to ) ? to : from;
 
-    sub_balance( from, quantity );
-    add_balance( to, quantity, payer );
+    const int64_t balance = sub_balance( from, quantity, from );
+    const int64_t to_balance = add_balance( to, quantity, payer );
 
     // user sends RAM token to contract
     // unwraps RAM, retires RAM token, and transfers RAM bytes to user
     // cannot use `on_notify` because contract cannot send inline action notifications to itself
-    if ( to == get_self() ) unwrap_ram( from, quantity );
+    if ( to == get_self() ) return unwrap_result( from, quantity, balance );
+
+    // disable transfers to accounts on egress list
+    check_disable_transfer( to );
+    return { balance, to_balance, eosiowram::get_supply( get_self() ), quantity.amount };
+}
+
+void wram::transfers( const name& from, const vector<transfer_params>& transfers )
+{
+    require_auth( from );
+    check( transfers.size() > 0, "transfers cannot be empty" );
+
+    require_recipient( from );
+
+    // validate all transfers & debit sender once with the total
+    asset total{0, RAM_SYMBOL};
+    for ( const auto& t : transfers ) {
+        check( from != t.to, "cannot transfer to self" );
+        check( is_account( t.to ), "to account does not exist");
+        check( t.quantity.symbol == RAM_SYMBOL, "symbol precision mismatch" );
+        check( t.quantity.is_valid(), "invalid quantity" );
+        check( t.quantity.amount > 0, "must transfer positive quantity" );
+        check( t.memo.size() <= 256, "memo has more than 256 bytes" );
+        total += t.quantity;
+    }
+    const int64_t balance = sub_balance( from, total, from );
+
+    // credit each recipient, checking the egress row loaded once
+    const auto egress = get_egress_row();
+    asset unwrap{0, RAM_SYMBOL};
+    for ( const auto& t : transfers ) {
+        require_recipient( t.to );
+
+        auto payer = has_auth( t.to ) ? t.to : from;
+        add_balance( t.to, t.quantity, payer );
+
+        if ( t.to == get_self() ) unwrap += t.quantity;
+
+        // disable transfers to accounts on egress list
+        check_disable_transfer( t.to, egress );
+    }
+
+    // user sends RAM token to contract
+    if ( unwrap.amount > 0 ) unwrap_ram( from, unwrap, balance );
+}
+
+void wram::approve( const name& owner, const name& spender, const int64_t amount )
+{
+    require_auth( owner );
+    check( owner != spender, "cannot approve self" );
+    check( is_account( spender ), "spender account does not exist" );
+    check( amount >= 0, "must approve non-negative amount" );
+
+    allowances _allowances( get_self(), owner.value );
+    auto itr = _allowances.find( spender.value );
+    if ( itr == _allowances.end() ) {
+        if ( amount == 0 ) return;
+        _allowances.emplace( owner, [&]( auto& a ) {
+            a.spender = spender;
+            a.amount = amount;
+        });
+    } else if ( amount == 0 ) {
+        _allowances.erase( itr );
+    } else {
+        _allowances.modify( itr, same_payer, [&]( auto& a ) {
+            a.amount = amount;
+        });
+    }
+}
+
+wram::transfer_result wram::transferfrom( const name& spender, const name& from, const name& to, const asset& quantity )
+{
+    check( from != to, "cannot transfer to self" );
+    require_auth( spender );
+    check( is_account( to ), "to account does not exist");
+
+    require_recipient( from );
+    require_recipient( to );
+
+    check( quantity.symbol == RAM_SYMBOL, "symbol precision mismatch" );
+    check( quantity.is_valid(), "invalid quantity" );
+    check( quantity.amount > 0, "must transfer positive quantity" );
+
+    // spend allowance, removed once used up
+    allowances _allowances( get_self(), from.value );
+    const auto& allowance = _allowances.get( spender.value, "no allowance for spender" );
+    check( allowance.amount >= quantity.amount, "transfer exceeds allowance" );
+    if ( allowance.amount == quantity.amount ) {
+        _allowances.erase( allowance );
+    } else {
+        _allowances.modify( allowance, same_payer, [&]( auto& a ) {
+            a.amount -= quantity.amount;
+        });
+    }
+
+    auto payer = has_auth( to ) ? to : spender;
+
+    const int64_t balance = sub_balance( from, quantity, spender );
+    const int64_t to_balance = add_balance( to, quantity, payer );
+
+    // tokens sent to contract are unwrapped to `from`
+    if ( to == get_self() ) return unwrap_result( from, quantity, balance );
 
     // disable transfers to accounts on egress list
     check_disable_transfer( to );
+    return { balance, to_balance, eosiowram::get_supply( get_self() ), quantity.amount };
 }
 
-void wram::sub_balance( const name& owner, const asset& value ) {
-   accounts from_acnts( get_self(), owner.value );
+// `ram_payer` other than `owner` (`transferfrom` spender) keeps the row payer & pays for a missing holder row
+int64_t wram::sub_balance( const name& owner, const asset& value, const name& ram_payer ) {
+   int64_t balance;
+   const name payer = ram_payer == owner ? owner : same_payer;
+
+   balances from_bals( get_self(), owner.value );
+   const auto from = from_bals.find( RAM_SYMBOL_CODE );
+   if ( from != from_bals.end() ) {
+      check( from->amount >= value.amount, "overdrawn balance" );
+      if ( from->amount == value.amount && reap_drained( owner ) ) {
+         from_bals.erase( from );
+         erase_holder( owner );
+         return 0;
+      }
+      from_bals.modify( from, payer, [&]( auto& a ) {
+         a.amount -= value.amount;
+      });
+      balance = from->amount;
+
+   // legacy balance row (not yet migrated)
+   } else {
+      accounts from_acnts( get_self(), owner.value );
+
+      const auto& from_legacy = from_acnts.get( RAM_SYMBOL_CODE, "no balance object found" );
+      check( from_legacy.balance.amount >= value.amount, "overdrawn balance" );
+      if ( from_legacy.balance.amount == value.amount && reap_drained( owner ) ) {
+         from_acnts.erase( from_legacy );
+         erase_holder( owner );
+         return 0;
+      }
+
+      from_acnts.modify( from_legacy, payer, [&]( auto& a ) {
+         a.balance -= value;
+      });
+      balance = from_legacy.balance.amount;
+   }
+
+   set_holder( owner, balance, ram_payer );
+   return balance;
+}
+
+int64_t wram::add_balance( const name& owner, const asset& value, const name& ram_payer )
+{
+   int64_t balance;
+
+   balances to_bals( get_self(), owner.value );
+   const auto to = to_bals.find( RAM_SYMBOL_CODE );
+   if ( to != to_bals.end() ) {
+      to_bals.modify( to, same_payer, [&]( auto& a ) {
+        a.amount += value.amount;
+      });
+      balance = to->amount;
+      WRAM_METRIC( balance_modifies, 1 );
 
-   const auto& from = from_acnts.get( value.symbol.code().raw(), "no balance object found" );
-   check( from.balance.amount >= value.amount, "overdrawn balance" );
+   // legacy balance row (not yet migrated)
+   } else {
+      accounts to_acnts( get_self(), owner.value );
+      auto to_legacy = to_acnts.find( RAM_SYMBOL_CODE );
+      if( to_legacy == to_acnts.end() ) {
+         if ( compact_balances() ) {
+            to_bals.emplace( ram_payer, [&]( auto& a ){
+              a.amount = value.amount;
+            });
+         } else {
+            to_acnts.emplace( ram_payer, [&]( auto& a ){
+              a.balance = value;
+            });
+         }
+         balance = value.amount;
+         WRAM_METRIC( balance_emplaces, 1 );
+      } else {
+         to_acnts.modify( to_legacy, same_payer, [&]( auto& a ) {
+           a.balance += value;
+         });
+         balance = to_legacy->balance.amount;
+         WRAM_METRIC( balance_modifies, 1 );
+      }
+   }
 
-   from_acnts.modify( from, owner, [&]( auto& a ) {
-      a.balance -= value;
-   });
+   set_holder( owner, balance, ram_payer );
+   return balance;
 }
 
-void wram::add_balance( const name& owner, const asset& value, const name& ram_payer )
+// update holder index, ram payer is only used for holders not yet indexed
+void wram::set_holder( const name& owner, const int64_t balance, const name& ram_payer )
 {
-   accounts to_acnts( get_self(), owner.value );
-   auto to = to_acnts.find( value.symbol.code().raw() );
-   if( to == to_acnts.end() ) {
-      to_acnts.emplace( ram_payer, [&]( auto& a ){
-        a.balance = value;
+   holders _holders( get_self(), get_self().value );
+   auto itr = _holders.find( owner.value );
+   const int64_t previous = itr == _holders.end() ? 0 : itr->balance;
+   if ( itr == _holders.end() ) {
+      _holders.emplace( ram_payer, [&]( auto& row ) {
+         row.owner = owner;
+         row.balance = balance;
       });
    } else {
-      to_acnts.modify( to, same_payer, [&]( auto& a ) {
-        a.balance += value;
+      _holders.modify( itr, same_payer, [&]( auto& row ) {
+         row.balance = balance;
       });
    }
+   audit_balance_changed( owner, balance - previous );
+}
+
+void wram::erase_holder( const name& owner )
+{
+   holders _holders( get_self(), get_self().value );
+   auto itr = _holders.find( owner.value );
+   if ( itr == _holders.end() ) return;
+
+   audit_balance_changed( owner, -itr->balance );
+   _holders.erase( itr );
+}
+
+// drained balance rows are erased when `auto_reap` is enabled, except the contract's own
+bool wram::reap_drained( const name& owner )
+{
+   if ( owner == get_self() ) return false;
+
+   config _config( get_self(), get_self().value );
+   return _config.get_or_default().auto_reap;
+}
+
+// new balances use compact rows once enabled, until then `accounts` table readers see every balance
+bool wram::compact_balances()
+{
+   config _config( get_self(), get_self().value );
+   return _config.get_or_default().compact_balances;
 }
 
 void wram::open( const name& owner, const symbol& symbol, const name& ram_payer )
@@ -146,28 +342,149 @@ void wram::open( const name& owner, const symbol& symbol, const name& ram_payer
 
    check( is_account( owner ), "owner account does not exist" );
 
-   auto sym_code_raw = symbol.code().raw();
-   stats statstable( get_self(), sym_code_raw );
-   const auto& st = statstable.get( sym_code_raw, "symbol does not exist" );
-   check( st.supply.symbol == symbol, "symbol precision mismatch" );
+   check( symbol == RAM_SYMBOL, "symbol precision mismatch" );
 
+   balances bals( get_self(), owner.value );
    accounts acnts( get_self(), owner.value );
-   auto it = acnts.find( sym_code_raw );
-   if( it == acnts.end() ) {
-      acnts.emplace( ram_payer, [&]( auto& a ){
-        a.balance = asset{0, symbol};
-      });
+   if( bals.find( RAM_SYMBOL_CODE ) == bals.end() && acnts.find( RAM_SYMBOL_CODE ) == acnts.end() ) {
+      if ( compact_balances() ) {
+         bals.emplace( ram_payer, [&]( auto& a ){
+           a.amount = 0;
+         });
+      } else {
+         acnts.emplace( ram_payer, [&]( auto& a ){
+           a.balance = asset{0, RAM_SYMBOL};
+         });
+      }
    }
 }
 
 void wram::close( const name& owner, const symbol& symbol )
 {
    require_auth( owner );
+   check( symbol == RAM_SYMBOL, "symbol precision mismatch" );
+
+   balances bals( get_self(), owner.value );
+   auto bal = bals.find( RAM_SYMBOL_CODE );
+   if ( bal != bals.end() ) {
+      check( bal->amount == 0, "Cannot close because the balance is not zero." );
+      bals.erase( bal );
+      erase_holder( owner );
+      return;
+   }
+
    accounts acnts( get_self(), owner.value );
-   auto it = acnts.find( symbol.code().raw() );
+   auto it = acnts.find( RAM_SYMBOL_CODE );
    check( it != acnts.end(), "Balance row already deleted or never existed. Action won't have any effect." );
    check( it->balance.amount == 0, "Cannot close because the balance is not zero." );
    acnts.erase( it );
+   erase_holder( owner );
+}
+
+void wram::migrate( const vector<name> owners )
+{
+   check( owners.size() > 0, "owners cannot be empty" );
+   check( owners.size() <= 100, "cannot migrate more than 100 owners per action" );
+   check( compact_balances(), "compact balances are disabled" );
+
+   // the contract may migrate any owner at its own expense, otherwise each owner migrates & pays for itself
+   const bool self = has_auth( get_self() );
+   for ( const name owner : owners ) {
+      check( self || has_auth( owner ), "missing authority of " + owner.to_string() );
+      const name payer = self ? get_self() : owner;
+
+      accounts acnts( get_self(), owner.value );
+      auto it = acnts.find( RAM_SYMBOL_CODE );
+      if ( it == acnts.end() ) continue; // skip if already migrated or no balance
+
+      const int64_t balance = it->balance.amount;
+      balances bals( get_self(), owner.value );
+      bals.emplace( payer, [&]( auto& a ){
+        a.amount = balance;
+      });
+      acnts.erase( it );
+      set_holder( owner, balance, payer );
+   }
+}
+
+uint32_t wram::index( const name payer, const vector<name> owners )
+{
+   require_auth( payer );
+   check( owners.size() > 0, "owners cannot be empty" );
+   check( owners.size() <= 100, "cannot index more than 100 owners per action" );
+
+   uint32_t indexed = 0;
+   holders _holders( get_self(), get_self().value );
+   for ( const name owner : owners ) {
+      if ( _holders.find( owner.value ) != _holders.end() ) continue; // already indexed
+
+      // compact balance row, then legacy balance row (not yet migrated)
+      const auto balance = find_balance( get_self(), owner, RAM_SYMBOL.code() );
+      if ( !balance ) continue;
+
+      set_holder( owner, balance->amount, payer );
+      indexed++;
+   }
+   return indexed;
+}
+
+void wram::setconfig( const bool auto_reap, const bool compact_balances )
+{
+   require_auth( get_self() );
+
+   config _config( get_self(), get_self().value );
+   auto row = _config.get_or_default();
+   row.auto_reap = auto_reap;
+   row.compact_balances = compact_balances;
+   _config.set( row, get_self() );
+}
+
+uint32_t wram::reap( const uint32_t limit, const vector<name> owners )
+{
+   check( limit <= 1000, "limit must be between 0 and 1000" );
+   check( owners.size() <= 100, "cannot reap more than 100 owners per action" );
+   check( limit > 0 || owners.size() > 0, "limit and owners cannot both be empty" );
+
+   config _config( get_self(), get_self().value );
+   check( _config.get_or_default().auto_reap, "reaping is disabled" );
+
+   // zero balances are ordered first
+   holders _holders( get_self(), get_self().value );
+   auto idx = _holders.get_index<"bybalance"_n>();
+   vector<name> indexed;
+   for ( auto itr = idx.lower_bound( 0 ); itr != idx.end() && itr->balance == 0 && indexed.size() < limit; ++itr ) {
+      if ( itr->owner != get_self() ) indexed.push_back( itr->owner );
+   }
+
+   uint32_t reaped = 0;
+   for ( const name owner : indexed ) {
+      check( reap_balance( owner ), "holder balance does not match balance row" );
+      reaped++;
+   }
+
+   // listed owners may hold legacy rows drained before being indexed, non-zero & missing rows are skipped
+   for ( const name owner : owners ) {
+      if ( owner != get_self() && reap_balance( owner ) ) reaped++;
+   }
+   return reaped;
+}
+
+// erase the zero balance row of `owner` (compact or legacy) & its holder row
+bool wram::reap_balance( const name& owner )
+{
+   balances bals( get_self(), owner.value );
+   auto bal = bals.find( RAM_SYMBOL_CODE );
+   if ( bal != bals.end() ) {
+      if ( bal->amount != 0 ) return false;
+      bals.erase( bal );
+   } else {
+      accounts acnts( get_self(), owner.value );
+      auto it = acnts.find( RAM_SYMBOL_CODE );
+      if ( it == acnts.end() || it->balance.amount != 0 ) return false;
+      acnts.erase( it );
+   }
+   erase_holder( owner );
+   return true;
 }
 
 } /// namespace eosio